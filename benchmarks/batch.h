@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../src/batch.h"
+#include "../src/movegen.h"
+#include "../tests/fens.h"
+
+// Replicates the BenchmarkPositions not in check into a batch of state.range(0) positions
+class BatchFixture : public benchmark::Fixture {
+   public:
+    void SetUp(::benchmark::State& state) override {
+        batch.clear();
+        positions.clear();
+
+        for (size_t i = 0; positions.size() < size_t(state.range(0)); ++i) {
+            Position pos(BenchmarkPositions[i % BenchmarkPositions.size()]);
+            if (!pos.checkers()) {
+                positions.push_back(pos);
+                batch.push_back(pos);
+            }
+        }
+    }
+
+    void TearDown(::benchmark::State& state) override {}
+
+    std::vector<Position> positions{};
+    Batch::PositionBatch batch{};
+    Batch::BatchResult result{};
+};
+
+void batch_benchmark(BatchFixture& fixture, Kernel kernel, benchmark::State& state) {
+    uint64_t numPositions = 0;
+    for (auto _ : state) {
+        Batch::generate(fixture.batch, fixture.result, kernel);
+        benchmark::DoNotOptimize(fixture.result.moveCounts.data());
+        numPositions += fixture.batch.size();
+    }
+    state.counters["Positions/Sec"] = benchmark::Counter(numPositions, benchmark::Counter::kIsRate);
+}
+
+// Reference for the batch kernels: one MoveList<NON_EVASIONS> per position, which generates the
+// same pseudo-legal moves plus castling
+BENCHMARK_DEFINE_F(BatchFixture, MoveListLoop)(benchmark::State& state) {
+    uint64_t numPositions = 0;
+    for (auto _ : state) {
+        for (const Position& pos : positions) {
+            benchmark::DoNotOptimize(MoveList<NON_EVASIONS>(pos).size());
+        }
+        numPositions += positions.size();
+    }
+    state.counters["Positions/Sec"] = benchmark::Counter(numPositions, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_DEFINE_F(BatchFixture, ScalarBatch)(benchmark::State& state) {
+    batch_benchmark(*this, SCALAR, state);
+}
+
+BENCHMARK_DEFINE_F(BatchFixture, Avx2Batch)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 is not supported");
+        return;
+    }
+    batch_benchmark(*this, AVX2, state);
+}
+
+BENCHMARK_DEFINE_F(BatchFixture, Avx512Batch)(benchmark::State& state) {
+    if (best_kernel() != AVX512) {
+        state.SkipWithError("AVX-512 is not supported");
+        return;
+    }
+    batch_benchmark(*this, AVX512, state);
+}
@@ -1,11 +1,54 @@
 #include <benchmark/benchmark.h>
-#include "../src/bitboard.h"
+#include "batch.h"
+#include "nnue.h"
 #include "positions.h"
 
 BENCHMARK_REGISTER_F(PositionFixture, MoveGeneration)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, FilteredMoveGeneration)
+    ->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, PextSliders)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, MagicSliders)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, HyperbolaSliders)
+    ->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, MakeUnmake)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, CheckedMakeUnmake)
+    ->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, CopyMake)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, Evaluate)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, CachedEvaluate)
+    ->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, StaticExchange)
+    ->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, QSearch)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, FenRoundTrip)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, PackRoundTrip)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, Perft)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, CopyMakePerft)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(PositionFixture, HashedPerft)
+    ->DenseRange(0, BenchmarkPositions.size() - 1)
+    ->Unit(benchmark::kMillisecond);
+// The search runs on its own thread, the calling thread only waits for it
+BENCHMARK_REGISTER_F(PositionFixture, Search)
+    ->DenseRange(0, BenchmarkPositions.size() - 1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_REGISTER_F(PositionFixture, ParallelSearch)
+    ->DenseRange(0, BenchmarkPositions.size() - 1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_REGISTER_F(NnueFixture, ScalarRefresh)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(NnueFixture, ScalarIncremental)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(NnueFixture, Avx2Refresh)->DenseRange(0, BenchmarkPositions.size() - 1);
+BENCHMARK_REGISTER_F(NnueFixture, Avx2Incremental)->DenseRange(0, BenchmarkPositions.size() - 1);
+
+// Batches of 4K and 64K positions
+BENCHMARK_REGISTER_F(BatchFixture, MoveListLoop)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK_REGISTER_F(BatchFixture, ScalarBatch)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK_REGISTER_F(BatchFixture, Avx2Batch)->Arg(1 << 12)->Arg(1 << 16);
+BENCHMARK_REGISTER_F(BatchFixture, Avx512Batch)->Arg(1 << 12)->Arg(1 << 16);
 
 int main(int argc, char** argv) {
-    Bitboards::init();
     benchmark ::MaybeReenterWithoutASLR(argc, argv);
     char arg0_default[] = "benchmark";
     char* args_default = reinterpret_cast<char*>(arg0_default);
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <optional>
+#include "../src/movegen.h"
+#include "../src/nnue.h"
+#include "../tests/fens.h"
+#include "../tests/network.h"
+
+// The network is written and mapped once for all benchmarks
+class NnueFixture : public benchmark::Fixture {
+   public:
+    void SetUp(::benchmark::State& state) override {
+        static const std::string path = write_random_network("chess-bench.nnue", 20261017);
+        if (!network.loaded() && !network.load(path)) {
+            state.SkipWithError("Cannot load the network");
+        }
+        position.emplace(BenchmarkPositions[state.range(0)]);
+    }
+
+    void TearDown(::benchmark::State& state) override {}
+
+    static inline NNUE::Network network{};
+    std::optional<Position> position{};
+};
+
+// Evaluates the position from scratch, both accumulators included
+void nnue_refresh_benchmark(NnueFixture& fixture, Kernel kernel, benchmark::State& state) {
+    const Position& pos = fixture.position.value();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(NNUE::evaluate(fixture.network, pos, kernel));
+    }
+    state.counters["Evals/Sec"] =
+        benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+// Evaluates every child of the position, updating the accumulators from the parent's as the
+// search does.
+void nnue_incremental_benchmark(NnueFixture& fixture,
+                                Kernel kernel,
+                                benchmark::State& state) {
+    Position pos = fixture.position.value();
+    const MoveList<LEGAL> moves(pos);
+    NNUE::AccumulatorStack stack(kernel);
+    StateInfo st;
+    uint64_t numEvals = 0;
+
+    stack.evaluate(fixture.network, pos);
+
+    for (auto _ : state) {
+        for (const auto& m : moves) {
+            pos.make_move(m, st);
+            stack.push(pos.dirty_piece());
+            benchmark::DoNotOptimize(stack.evaluate(fixture.network, pos));
+            stack.pop();
+            pos.unmake_move(m);
+        }
+        numEvals += moves.size();
+    }
+    state.counters["Evals/Sec"] = benchmark::Counter(numEvals, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_DEFINE_F(NnueFixture, ScalarRefresh)(benchmark::State& state) {
+    nnue_refresh_benchmark(*this, SCALAR, state);
+}
+
+BENCHMARK_DEFINE_F(NnueFixture, ScalarIncremental)(benchmark::State& state) {
+    nnue_incremental_benchmark(*this, SCALAR, state);
+}
+
+BENCHMARK_DEFINE_F(NnueFixture, Avx2Refresh)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 is not supported");
+        return;
+    }
+    nnue_refresh_benchmark(*this, AVX2, state);
+}
+
+BENCHMARK_DEFINE_F(NnueFixture, Avx2Incremental)(benchmark::State& state) {
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("AVX2 is not supported");
+        return;
+    }
+    nnue_incremental_benchmark(*this, AVX2, state);
+}
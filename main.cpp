@@ -4,8 +4,6 @@
 #include "src/gui.h"
 
 int main(int argc, char* argv[]) {
-    Bitboards::init();
-
     ChessGUI().loop();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,216 @@
+#include "batch.h"
+#include <bit>
+#include <cassert>
+#include <cstring>
+#include <type_traits>
+#include "bitboard.h"
+
+namespace Batch {
+
+void PositionBatch::push_back(const Position& pos) {
+    assert(!pos.checkers());
+
+    if (count == us.size()) {
+        for (auto* field : {&pawns, &knights, &bishopsQueens, &rooksQueens, &kings, &us, &them,
+                            &epSquares}) {
+            field->resize(count + Width);
+        }
+        mirrored.resize(count + Width);
+    }
+
+    const Color c = pos.side_to_move();
+    auto orient = [c](Bitboard b) { return c == WHITE ? b : std::byteswap(b); };
+
+    pawns[count] = orient(pos.pieces<PAWN>(c));
+    knights[count] = orient(pos.pieces<KNIGHT>(c));
+    bishopsQueens[count] = orient(pos.pieces<BISHOP, QUEEN>(c));
+    rooksQueens[count] = orient(pos.pieces<ROOK, QUEEN>(c));
+    kings[count] = orient(pos.pieces<KING>(c));
+    us[count] = orient(pos.pieces(c));
+    them[count] = orient(pos.pieces(~c));
+    epSquares[count] = pos.ep_square() != SQ_NONE ? orient(square_bb(pos.ep_square())) : 0;
+    mirrored[count] = c == BLACK;
+    ++count;
+}
+
+void PositionBatch::clear() {
+    for (auto* field :
+         {&pawns, &knights, &bishopsQueens, &rooksQueens, &kings, &us, &them, &epSquares}) {
+        field->clear();
+    }
+    mirrored.clear();
+    count = 0;
+}
+
+namespace {
+
+// The kernel is written once over V, which is either a Bitboard or a GCC vector of them. All
+// helpers are always inlined, so the vector code is compiled for the target of the calling
+// kernel and no vector crosses a function boundary.
+
+using Vec4 = Bitboard __attribute__((vector_size(32)));
+using Vec8 = Bitboard __attribute__((vector_size(64)));
+
+template <typename V>
+constexpr size_t Lanes = sizeof(V) / sizeof(Bitboard);
+
+constexpr Bitboard AllSquares = ~Bitboard(0);
+
+template <typename V>
+[[gnu::always_inline]] inline V load(const std::vector<Bitboard>& field, size_t i) {
+    V v;
+    std::memcpy(&v, field.data() + i, sizeof(V));
+    return v;
+}
+
+template <typename V>
+[[gnu::always_inline]] inline Bitboard lane(V v, size_t l) {
+    if constexpr (std::is_same_v<V, Bitboard>) {
+        return v;
+    } else {
+        return v[l];
+    }
+}
+
+template <typename V>
+[[gnu::always_inline]] inline V popcount_lanes(V v) {
+    if constexpr (std::is_same_v<V, Bitboard>) {
+        return std::popcount(v);
+    } else {
+        V counts;
+        for (size_t l = 0; l < Lanes<V>; ++l) {
+            counts[l] = std::popcount(v[l]);
+        }
+        return counts;
+    }
+}
+
+// Shifts by the given number of squares, clearing the squares in which a step across the board
+// edge would land.
+template <int Shift, Bitboard Mask, typename V>
+[[gnu::always_inline]] inline V step(V b) {
+    if constexpr (Shift > 0) {
+        return (b << Shift) & Mask;
+    } else {
+        return (b >> -Shift) & Mask;
+    }
+}
+
+// Returns the attacks of all the sliders along one direction with a Kogge-Stone occluded fill.
+// A square is reached by at most one of the sliders, since the nearer one blocks the others.
+template <int Shift, Bitboard Mask, typename V>
+[[gnu::always_inline]] inline V slide(V sliders, V empty) {
+    V pro = empty & Mask;
+
+    sliders |= pro & step<Shift, AllSquares>(sliders);
+    pro &= step<Shift, AllSquares>(pro);
+    sliders |= pro & step<2 * Shift, AllSquares>(sliders);
+    pro &= step<2 * Shift, AllSquares>(pro);
+    sliders |= pro & step<4 * Shift, AllSquares>(sliders);
+
+    return step<Shift, Mask>(sliders);
+}
+
+// Adds the moves to the targets to the count and the moves themselves to the attacks.
+template <typename V>
+[[gnu::always_inline]] inline void add(V moves, V targets, V& count, V& attacks) {
+    count += popcount_lanes(moves & targets);
+    attacks |= moves;
+}
+
+// Counts the moves and collects the attacks of Lanes<V> positions starting at index i. Moves are
+// counted per direction or per knight jump, along which every target has a single origin.
+template <typename V>
+[[gnu::always_inline]] inline void generate_lanes(const PositionBatch& batch,
+                                                  size_t i,
+                                                  BatchResult& result) {
+    const V pawns = load<V>(batch.pawns, i);
+    const V knights = load<V>(batch.knights, i);
+    const V bishopsQueens = load<V>(batch.bishopsQueens, i);
+    const V rooksQueens = load<V>(batch.rooksQueens, i);
+    const V kings = load<V>(batch.kings, i);
+    const V us = load<V>(batch.us, i);
+    const V them = load<V>(batch.them, i);
+    const V epSquares = load<V>(batch.epSquares, i);
+
+    const V empty = ~(us | them);
+    const V targets = ~us;
+
+    // Pawns: pushes, double pushes, captures and en passant, with four moves per promotion
+    const V push = step<8, AllSquares>(pawns) & empty;
+    const V westCaptures = step<7, ~FileHBB>(pawns) & (them | epSquares);
+    const V eastCaptures = step<9, ~FileABB>(pawns) & (them | epSquares);
+
+    V attacks = step<7, ~FileHBB>(pawns) | step<9, ~FileABB>(pawns);
+    V count = popcount_lanes(push) + popcount_lanes(step<8, AllSquares>(push & Rank3BB) & empty) +
+              popcount_lanes(westCaptures) + popcount_lanes(eastCaptures);
+
+    count += 3 * (popcount_lanes(push & Rank8BB) + popcount_lanes(westCaptures & Rank8BB) +
+                  popcount_lanes(eastCaptures & Rank8BB));
+
+    add(step<17, ~FileABB>(knights), targets, count, attacks);
+    add(step<15, ~FileHBB>(knights), targets, count, attacks);
+    add(step<10, ~(FileABB | FileBBB)>(knights), targets, count, attacks);
+    add(step<6, ~(FileGBB | FileHBB)>(knights), targets, count, attacks);
+    add(step<-6, ~(FileABB | FileBBB)>(knights), targets, count, attacks);
+    add(step<-10, ~(FileGBB | FileHBB)>(knights), targets, count, attacks);
+    add(step<-15, ~FileABB>(knights), targets, count, attacks);
+    add(step<-17, ~FileHBB>(knights), targets, count, attacks);
+
+    add(step<8, AllSquares>(kings) | step<-8, AllSquares>(kings) | step<1, ~FileABB>(kings) |
+        step<-1, ~FileHBB>(kings) | step<9, ~FileABB>(kings) | step<7, ~FileHBB>(kings) |
+        step<-7, ~FileABB>(kings) | step<-9, ~FileHBB>(kings), targets, count, attacks);
+
+    add(slide<8, AllSquares>(rooksQueens, empty), targets, count, attacks);
+    add(slide<-8, AllSquares>(rooksQueens, empty), targets, count, attacks);
+    add(slide<1, ~FileABB>(rooksQueens, empty), targets, count, attacks);
+    add(slide<-1, ~FileHBB>(rooksQueens, empty), targets, count, attacks);
+    add(slide<9, ~FileABB>(bishopsQueens, empty), targets, count, attacks);
+    add(slide<7, ~FileHBB>(bishopsQueens, empty), targets, count, attacks);
+    add(slide<-7, ~FileABB>(bishopsQueens, empty), targets, count, attacks);
+    add(slide<-9, ~FileHBB>(bishopsQueens, empty), targets, count, attacks);
+
+    for (size_t l = 0; l < Lanes<V>; ++l) {
+        Bitboard a = lane(attacks, l);
+        result.moveCounts[i + l] = uint32_t(lane(count, l));
+        result.attacks[i + l] = batch.mirrored[i + l] ? std::byteswap(a) : a;
+    }
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void generate_all(const PositionBatch& batch, BatchResult& result) {
+    for (size_t i = 0; i < batch.padded_size(); i += Lanes<V>) {
+        generate_lanes<V>(batch, i, result);
+    }
+}
+
+void generate_scalar(const PositionBatch& batch, BatchResult& result) {
+    generate_all<Bitboard>(batch, result);
+}
+
+[[gnu::target("avx2")]] void generate_avx2(const PositionBatch& batch, BatchResult& result) {
+    generate_all<Vec4>(batch, result);
+}
+
+[[gnu::target("avx512f,avx512vpopcntdq")]] void generate_avx512(const PositionBatch& batch,
+                                                                 BatchResult& result) {
+    generate_all<Vec8>(batch, result);
+}
+
+}  // namespace
+
+void generate(const PositionBatch& batch, BatchResult& result, Kernel kernel) {
+    result.moveCounts.resize(batch.padded_size());
+    result.attacks.resize(batch.padded_size());
+
+    switch (kernel) {
+        case AVX512: generate_avx512(batch, result); break;
+        case AVX2: generate_avx2(batch, result); break;
+        default: generate_scalar(batch, result);
+    }
+
+    result.moveCounts.resize(batch.size());
+    result.attacks.resize(batch.size());
+}
+
+}  // namespace Batch
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "position.h"
+#include "types.h"
+#include "utils.h"
+
+namespace Batch {
+
+// Positions are processed in groups of Width, the lane count of the widest kernel. Batches are
+// padded with empty positions to a multiple of it.
+constexpr size_t Width = 8;
+
+// The bitboards of many positions in structure-of-arrays layout, so that consecutive positions
+// fill the lanes of a SIMD register. Every position is seen from its side to move: positions
+// with black to move are mirrored vertically, so all pawns push north.
+class PositionBatch {
+   public:
+    // The position must not be in check, since the kernels do not generate evasions
+    void push_back(const Position& pos);
+    void clear();
+
+    size_t size() const { return count; }
+
+    // Lanes of padding positions are empty and yield no moves
+    size_t padded_size() const { return us.size(); }
+
+    std::vector<Bitboard> pawns{};
+    std::vector<Bitboard> knights{};
+    std::vector<Bitboard> bishopsQueens{};
+    std::vector<Bitboard> rooksQueens{};
+    std::vector<Bitboard> kings{};
+    std::vector<Bitboard> us{};
+    std::vector<Bitboard> them{};
+    std::vector<Bitboard> epSquares{};
+    std::vector<uint8_t> mirrored{};
+
+   private:
+    size_t count = 0;
+};
+
+// moveCounts holds the number of pseudo-legal moves of each position as generate<NON_EVASIONS>
+// would produce them, without castling. Moves leaving the king in check are counted, so the
+// counts are not legal move counts. attacks holds the squares attacked by the side to move,
+// in board orientation.
+struct BatchResult {
+    std::vector<uint32_t> moveCounts{};
+    std::vector<Bitboard> attacks{};
+};
+
+void generate(const PositionBatch& batch, BatchResult& result, Kernel kernel = best_kernel());
+
+}  // namespace Batch
@@ -1,62 +1,101 @@
-#include <immintrin.h>
 #include "bitboard.h"
+#include <cpuid.h>
 
-namespace Bitboards {                 // Make sure it is only initialized once
-inline Bitboard RookTable[0x19000];   // To store rook attacks
-inline Bitboard BishopTable[0x1480];  // To store bishop attacks
+namespace {
 
-inline void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]);
-}  // namespace Bitboards
+// Rook directions first, then bishop directions
+constexpr Direction RayDirections[8]{NORTH,      EAST,       SOUTH,      WEST,
+                                     NORTH_EAST, NORTH_WEST, SOUTH_EAST, SOUTH_WEST};
+
+// The squares reached from every square along every direction on an empty board
+constexpr auto Rays = []() constexpr {
+    std::array<std::array<Bitboard, 8>, SQUARE_NB> rays{};
 
-alignas(64) Magic Magics[SQUARE_NB][2];
-
-Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
-Bitboard LineBB[SQUARE_NB][SQUARE_NB];
-
-// Initializes various bitboard tables. It is called at
-// startup and relies on global objects to be already zero-initialized.
-void Bitboards::init() {
-    std::cout << "Initializing bitboards...\n";
-    Bitboards::init_magics(ROOK, RookTable, Magics);
-    Bitboards::init_magics(BISHOP, BishopTable, Magics);
-
-    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1) {
-        for (PieceType pt : {BISHOP, ROOK}) {
-            for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2) {
-                if (PseudoAttacks[pt][s1] & s2) {
-                    LineBB[s1][s2] = (attacks_bb(pt, s1, 0) & attacks_bb(pt, s2, 0)) | s1 | s2;
-                    BetweenBB[s1][s2] =
-                        (attacks_bb(pt, s1, square_bb(s2)) & attacks_bb(pt, s2, square_bb(s1)));
-                }
-                BetweenBB[s1][s2] |= s2;
+    for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+        for (int i = 0; i < 8; ++i) {
+            for (Square to = s; Bitboards::safe_destination(to, RayDirections[i]);) {
+                rays[s][i] |= (to += RayDirections[i]);
             }
         }
     }
+
+    return rays;
+}();
+
+// Same as Bitboards::sliding_attack(), but cuts each ray at its first blocker instead of walking
+// it. Stepping through every square exceeds the constexpr evaluation limits for the full table.
+constexpr Bitboard ray_attacks(PieceType pt, Square s, Bitboard occupied) {
+    Bitboard attacks = 0;
+
+    for (int i = pt == ROOK ? 0 : 4, last = i + 4; i < last; ++i) {
+        Bitboard ray = Rays[s][i];
+
+        if (Bitboard blockers = ray & occupied) {
+            Square first = RayDirections[i] > 0 ? Square(std::countr_zero(blockers))
+                                                 : Square(63 - std::countl_zero(blockers));
+            ray ^= Rays[first][i];
+        }
+        attacks |= ray;
+    }
+
+    return attacks;
 }
 
-namespace Bitboards {
+// Enumerates the subsets of each mask with the carry-rippler trick and stores their attacks at
+// the index given by index(magic, subset).
+template <typename Index>
+constexpr std::array<Bitboard, SliderTableSize> slider_table(Index index) {
+    std::array<Bitboard, SliderTableSize> attacks{};
+
+    for (PieceType pt : {BISHOP, ROOK}) {
+        for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+            const Magic& m = Magics[s][pt - BISHOP];
+            Bitboard b = 0;
+
+            do {
+                attacks[index(m, b)] = ray_attacks(pt, s, b);
+                b = (b - m.mask) & m.mask;
+            } while (b);
+        }
+    }
+
+    return attacks;
+}
+
+}  // namespace
+
+// The subsets come in increasing order, which is also the order of their PEXT indices. PEXT
+// cannot run at compile time, so the index is counted instead.
+alignas(64) constexpr std::array<Bitboard, SliderTableSize> PextAttacks =
+    slider_table([index = uint32_t(0)](const Magic&, Bitboard) mutable { return index++; });
 
-void init_magics(PieceType pt, Bitboard table[], Magic magics[][2]) {
-    int size{0};
-    int total_size{0};
-    for (Square s{SQ_A1}; s <= SQ_H8; ++s) {
-        Bitboard edges{((Rank1BB | Rank8BB) & ~rank_bb(s)) | ((FileABB | FileHBB) & ~file_bb(s))};
+alignas(64) constexpr std::array<Bitboard, SliderTableSize> MagicAttacks =
+    slider_table([](const Magic& m, Bitboard b) { return m.magic_index(b); });
 
-        Magic& m{magics[s][pt - BISHOP]};
-        m.mask = Bitboards::sliding_attack(pt, s, 0) & ~edges;
+namespace Bitboards {
+
+#ifndef SLIDERS
+SliderBackend Sliders = detect_slider_backend();
+#endif
 
-        m.attacks = s == SQ_A1 ? table : magics[s - 1][pt - BISHOP].attacks + size;
-        size = 0;
+// Prefers PEXT where it runs in hardware. Zen 1 and Zen 2 (AMD family 17h, and the Hygon
+// family 18h derived from it) implement it in microcode, taking hundreds of cycles.
+SliderBackend detect_slider_backend() {
+    __builtin_cpu_init();
 
-        Bitboard b{0};
-        do {
-            m.attacks[_pext_u64(b, m.mask)] = Bitboards::sliding_attack(pt, s, b);
+    if (!__builtin_cpu_supports("bmi2")) {
+        return MAGIC;
+    }
 
-            ++size;
-            b = (b - m.mask) & m.mask;
-        } while (b);
-        total_size += size;
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        unsigned family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+        if (family == 0x17 || family == 0x18) {
+            return MAGIC;
+        }
     }
-    std::cout << "Magic table size: " << 8 * total_size << " bytes\n";
+
+    return PEXT;
 }
+
 }  // namespace Bitboards
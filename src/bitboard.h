@@ -6,14 +6,11 @@
 #include <immintrin.h>
 #include <popcntintrin.h>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cstdint>
 #include "types.h"
 
-namespace Bitboards {
-void init();
-}
-
 constexpr Bitboard FileABB = 0x0101010101010101ULL;
 constexpr Bitboard FileBBB = FileABB << 1;
 constexpr Bitboard FileCBB = FileABB << 2;
@@ -32,47 +29,11 @@ constexpr Bitboard Rank6BB = Rank1BB << (8 * 5);
 constexpr Bitboard Rank7BB = Rank1BB << (8 * 6);
 constexpr Bitboard Rank8BB = Rank1BB << (8 * 7);
 
-extern Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
-extern Bitboard LineBB[SQUARE_NB][SQUARE_NB];
-
-// inline constexpr Bitboard pext(Bitboard b, Bitboard m) {
-//     return _pext_u64(b, m);
-// }
-
-struct Magic {
-    Bitboard mask;
-    Bitboard* attacks;
-
-    inline constexpr uint64_t index(Bitboard occupied) const { return _pext_u64(occupied, mask); }
-
-    constexpr Bitboard attacks_bb(Bitboard occupied) const { return attacks[index(occupied)]; }
-};
-
-extern Magic Magics[SQUARE_NB][2];
 constexpr Bitboard square_bb(Square s) {
     assert(is_ok(s));
     return (1ULL << s);
 }
 
-// Returns a bitboard representing the squares in the semi-open
-// segment between the squares s1 and s2 (excluding s1 but including s2). If the
-// given squares are not on a same file/rank/diagonal, it returns s2. For instance,
-// between_bb(SQ_C4, SQ_F7) will return a bitboard with squares D5, E6 and F7, but
-// between_bb(SQ_E6, SQ_F8) will return a bitboard with the square F8. This trick
-// allows to generate non-king evasion moves faster: the defending piece must either
-// interpose itself to cover the check or capture the checking piece.
-constexpr Bitboard between_bb(Square s1, Square s2) {
-    return BetweenBB[s1][s2];
-}
-
-// Returns a bitboard representing an entire line (from board edge
-// to board edge) that intersects the two given squares. If the given squares
-// are not on a same file/rank/diagonal, the function returns 0. For instance,
-// line_bb(SQ_C4, SQ_F7) will return a bitboard with the A2-G8 diagonal.
-constexpr Bitboard line_bb(Square s1, Square s2) {
-    return LineBB[s1][s2];
-}
-
 // Overloads of bitwise operators between a Bitboard and a Square for testing
 // whether a given bit is set in a bitboard, and for setting and clearing bits.
 
@@ -208,6 +169,31 @@ constexpr Bitboard pawn_attacks_bb(Bitboard b) {
                       : shift<SOUTH_WEST>(b) | shift<SOUTH_EAST>(b);
 }
 
+// The ranks in front of s from the point of view of c, the rank of s excluded
+constexpr Bitboard forward_ranks_bb(Color c, Square s) {
+    return c == WHITE ? ~Rank1BB << 8 * relative_rank(WHITE, s)
+                      : ~Rank8BB >> 8 * relative_rank(BLACK, s);
+}
+
+constexpr Bitboard adjacent_files_bb(Square s) {
+    return shift<EAST>(file_bb(s)) | shift<WEST>(file_bb(s));
+}
+
+// The squares in front of s on its file, from the point of view of c
+constexpr Bitboard forward_file_bb(Color c, Square s) {
+    return forward_ranks_bb(c, s) & file_bb(s);
+}
+
+// The squares a pawn of color c on s could attack while advancing
+constexpr Bitboard pawn_attack_span(Color c, Square s) {
+    return forward_ranks_bb(c, s) & adjacent_files_bb(s);
+}
+
+// The squares that must be free of enemy pawns for a pawn of color c on s to be passed
+constexpr Bitboard passed_pawn_span(Color c, Square s) {
+    return pawn_attack_span(c, s) | forward_file_bb(c, s);
+}
+
 namespace Bitboards {
 
 // Returns the bitboard of target square for the given step
@@ -282,6 +268,249 @@ inline constexpr auto PseudoAttacks = []() constexpr {
     return attacks;
 }();
 
+namespace Bitboards {
+
+// The implementations of the rook and bishop attack lookup. PEXT and MAGIC share the table
+// layout but index it differently. HYPERBOLA needs no large table. The first one is the default
+// until the CPU has been inspected, so it must work everywhere.
+enum SliderBackend : uint8_t {
+    HYPERBOLA,
+    MAGIC,
+    PEXT,
+};
+
+// The backend used by attacks_bb(). It is detected from CPUID at startup unless SLIDERS names
+// one at compile time.
+#ifdef SLIDERS
+inline constexpr SliderBackend Sliders = SLIDERS;
+#else
+extern SliderBackend Sliders;
+#endif
+
+SliderBackend detect_slider_backend();
+
+}  // namespace Bitboards
+
+// Uses inline assembly when BMI2 is not enabled for the whole build, so that the PEXT backend
+// can still be selected at runtime.
+inline uint64_t pext(Bitboard b, Bitboard mask) {
+#ifdef __BMI2__
+    return _pext_u64(b, mask);
+#else
+    uint64_t result;
+    asm("pextq %2, %1, %0" : "=r"(result) : "r"(b), "rm"(mask));
+    return result;
+#endif
+}
+
+// Fancy magic numbers for the relevant occupancy masks, with one bit of index per bit of mask.
+// They were found offline with a random search, so they need no startup initialization.
+inline constexpr Bitboard BishopMagics[SQUARE_NB]{
+    0x2008021012002502ULL, 0x04D0100110628400ULL, 0x21102080A1021010ULL, 0x2044041080000400ULL,
+    0x0004050402800000ULL, 0x0002010420109560ULL, 0x08040084500A0000ULL, 0x9401002104224008ULL,
+    0x40044350070B0100ULL, 0x90B00888088C1040ULL, 0x0100100440444012ULL, 0x80001104008A0940ULL,
+    0x1042920210504048ULL, 0x0000010420048200ULL, 0x000000A410221000ULL, 0x804800829C901001ULL,
+    0x0040002008010120ULL, 0x8802008424280205ULL, 0x200800010A040010ULL, 0x2420800802004008ULL,
+    0x0012011402A21220ULL, 0x2002028508022208ULL, 0x0486200049100802ULL, 0x2000211101080200ULL,
+    0x8020200044140C60ULL, 0x0810680C05080381ULL, 0x0001442028012400ULL, 0x4028088008020002ULL,
+    0x25C1001041004010ULL, 0x0401020049080140ULL, 0x0004004084210400ULL, 0x40010900104400A0ULL,
+    0x011011480004A800ULL, 0x0082020200A0680BULL, 0x0800203000080082ULL, 0x0005020081880080ULL,
+    0x1050120080001004ULL, 0x0020008880030810ULL, 0x2241180900008C30ULL, 0x0201451101012400ULL,
+    0x8444016008025000ULL, 0x0002080104000800ULL, 0x2801001490090200ULL, 0x0500142018001100ULL,
+    0x0300040408200400ULL, 0x0008008800820810ULL, 0x0804210204004212ULL, 0x000800A698800202ULL,
+    0x0411040202401000ULL, 0x0A008C051802000EULL, 0x1002A100A8040022ULL, 0x00000C0084042600ULL,
+    0x1000884048220000ULL, 0x0082200410208000ULL, 0x0222020441140022ULL, 0x1004080800408810ULL,
+    0x0022410801500201ULL, 0x010000410818020BULL, 0x2044000044040410ULL, 0x00200C0100208801ULL,
+    0x080800200A102400ULL, 0x000404C010020090ULL, 0x1002101418808C03ULL, 0x0011300081040020ULL,
+};
+
+inline constexpr Bitboard RookMagics[SQUARE_NB]{
+    0xA680042040001480ULL, 0x40C0014010002000ULL, 0x0200100820804202ULL, 0x0900100008210004ULL,
+    0x4A00108402000820ULL, 0x2200040200018810ULL, 0x03000100220008ACULL, 0x4080002044800D00ULL,
+    0x008C800080400820ULL, 0x400240012002D000ULL, 0x0001001041002008ULL, 0x0110801000080080ULL,
+    0x0001000500100800ULL, 0x8A46000408020010ULL, 0x00040010084104A2ULL, 0x014A000220804401ULL,
+    0x80102A8000400088ULL, 0x0020008020804000ULL, 0x4010008010200081ULL, 0x0208010100100020ULL,
+    0x2091010008001005ULL, 0x0002008080020400ULL, 0x240024001110C208ULL, 0x0400120001008054ULL,
+    0x8080208080004004ULL, 0x80DD5004C0042000ULL, 0x0410040120080120ULL, 0x2000D00180380080ULL,
+    0x0008000880040080ULL, 0x100A000200080410ULL, 0x0300080400100102ULL, 0x6200008200011044ULL,
+    0x061481400C800060ULL, 0x1001004001002084ULL, 0x0000200080801000ULL, 0x840010010100200BULL,
+    0x0028040080800800ULL, 0x0882000406001830ULL, 0x0001005421001200ULL, 0x000001804600010CULL,
+    0x0000804000208000ULL, 0x4400402010044000ULL, 0x4010008020028014ULL, 0x0000090410010020ULL,
+    0x0000080100110005ULL, 0x0A00201004080140ULL, 0x0000040200010100ULL, 0x0220007081020004ULL,
+    0x840205C981002A00ULL, 0x0000804000200480ULL, 0x0002081040802200ULL, 0x0240230010000900ULL,
+    0x0044800800240180ULL, 0x4011000400080300ULL, 0x00101011088A0C00ULL, 0x1003000080420100ULL,
+    0x0180102100408001ULL, 0x1100108040010021ULL, 0x0182004008108022ULL, 0x0122900128202501ULL,
+    0x0002012004100802ULL, 0x00C200834C081002ULL, 0x0440020110083084ULL, 0x4000484884010022ULL,
+};
+
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    uint32_t offset;
+    uint32_t shift;
+
+    uint64_t pext_index(Bitboard occupied) const { return offset + pext(occupied, mask); }
+
+    constexpr uint64_t magic_index(Bitboard occupied) const {
+        return offset + (((occupied & mask) * magic) >> shift);
+    }
+};
+
+// The relevant occupancy masks of the rook and bishop on every square, and the offsets of their
+// attacks in PextAttacks and MagicAttacks.
+inline constexpr auto Magics = []() constexpr {
+    std::array<std::array<Magic, 2>, SQUARE_NB> magics{};
+    uint32_t offset = 0;
+
+    for (PieceType pt : {BISHOP, ROOK}) {
+        for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+            Bitboard edges =
+                ((Rank1BB | Rank8BB) & ~rank_bb(s)) | ((FileABB | FileHBB) & ~file_bb(s));
+            Bitboard mask = Bitboards::sliding_attack(pt, s, 0) & ~edges;
+            Bitboard magic = pt == ROOK ? RookMagics[s] : BishopMagics[s];
+
+            magics[s][pt - BISHOP] = {mask, magic, offset, uint32_t(64 - std::popcount(mask))};
+            offset += 1 << std::popcount(mask);
+        }
+    }
+
+    return magics;
+}();
+
+inline constexpr size_t SliderTableSize = 0x19000 + 0x1480;
+
+// The rook and bishop attacks for every relevant occupancy, indexed by Magic::pext_index() and
+// Magic::magic_index() respectively. They are generated at compile time in bitboard.cpp.
+extern const std::array<Bitboard, SliderTableSize> PextAttacks;
+extern const std::array<Bitboard, SliderTableSize> MagicAttacks;
+
+// The lines through every square used by hyperbola quintessence, without the square itself.
+// Ranks cannot be mirrored with a byte swap and use RankAttacks instead.
+struct HyperbolaMask {
+    Bitboard file;
+    Bitboard diagonal;
+    Bitboard antiDiagonal;
+};
+
+inline constexpr auto HyperbolaMasks = []() constexpr {
+    std::array<HyperbolaMask, SQUARE_NB> masks{};
+
+    for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+        Bitboard diagonals = PseudoAttacks[BISHOP][s];
+        Bitboard diagonal = 0;
+
+        for (Square to = s; Bitboards::safe_destination(to, NORTH_EAST);) {
+            diagonal |= (to += NORTH_EAST);
+        }
+        for (Square to = s; Bitboards::safe_destination(to, SOUTH_WEST);) {
+            diagonal |= (to += SOUTH_WEST);
+        }
+
+        masks[s] = {file_bb(s) ^ s, diagonal, diagonals ^ diagonal};
+    }
+
+    return masks;
+}();
+
+// The attacks along the first rank from every file, for every occupancy of files B to G
+inline constexpr auto RankAttacks = []() constexpr {
+    std::array<std::array<uint8_t, 64>, FILE_NB> attacks{};
+
+    for (File f = FILE_A; f <= FILE_H; ++f) {
+        for (Bitboard occupied = 0; occupied < 64; ++occupied) {
+            attacks[f][occupied] =
+                uint8_t(Bitboards::sliding_attack(ROOK, Square(f), occupied << 1) & Rank1BB);
+        }
+    }
+
+    return attacks;
+}();
+
+// Returns the attacks of a slider on s along the given line, which must not contain s. The
+// attacks towards higher squares come from o - s, and towards lower squares from the same
+// computation on the byte-swapped, that is vertically mirrored, line.
+constexpr Bitboard hyperbola_attacks(Square s, Bitboard occupied, Bitboard line) {
+    Bitboard forward = occupied & line;
+    Bitboard reverse = std::byteswap(forward);
+
+    forward -= square_bb(s);
+    reverse -= std::byteswap(square_bb(s));
+
+    return (forward ^ std::byteswap(reverse)) & line;
+}
+
+// Returns the attacks of a bishop or rook with the given backend
+template <PieceType Pt, Bitboards::SliderBackend B>
+inline Bitboard slider_attacks(Square s, Bitboard occupied) {
+    static_assert(Pt == BISHOP || Pt == ROOK, "Unsupported type in slider_attacks()");
+
+    if constexpr (B == Bitboards::PEXT) {
+        return PextAttacks[Magics[s][Pt - BISHOP].pext_index(occupied)];
+    } else if constexpr (B == Bitboards::MAGIC) {
+        return MagicAttacks[Magics[s][Pt - BISHOP].magic_index(occupied)];
+    } else if constexpr (Pt == BISHOP) {
+        return hyperbola_attacks(s, occupied, HyperbolaMasks[s].diagonal) |
+               hyperbola_attacks(s, occupied, HyperbolaMasks[s].antiDiagonal);
+    } else {
+        int shift = 8 * rank_of(s);
+        return hyperbola_attacks(s, occupied, HyperbolaMasks[s].file) |
+               Bitboard(RankAttacks[file_of(s)][(occupied >> (shift + 1)) & 63]) << shift;
+    }
+}
+
+inline constexpr auto BetweenBB = []() constexpr {
+    std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> between{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1) {
+        for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2) {
+            for (PieceType pt : {BISHOP, ROOK}) {
+                if (PseudoAttacks[pt][s1] & s2) {
+                    between[s1][s2] = Bitboards::sliding_attack(pt, s1, square_bb(s2)) &
+                                      Bitboards::sliding_attack(pt, s2, square_bb(s1));
+                }
+            }
+            between[s1][s2] |= s2;
+        }
+    }
+
+    return between;
+}();
+
+inline constexpr auto LineBB = []() constexpr {
+    std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> lines{};
+
+    for (Square s1 = SQ_A1; s1 <= SQ_H8; ++s1) {
+        for (Square s2 = SQ_A1; s2 <= SQ_H8; ++s2) {
+            for (PieceType pt : {BISHOP, ROOK}) {
+                if (PseudoAttacks[pt][s1] & s2) {
+                    lines[s1][s2] = (PseudoAttacks[pt][s1] & PseudoAttacks[pt][s2]) | s1 | s2;
+                }
+            }
+        }
+    }
+
+    return lines;
+}();
+
+// Returns a bitboard representing the squares in the semi-open
+// segment between the squares s1 and s2 (excluding s1 but including s2). If the
+// given squares are not on a same file/rank/diagonal, it returns s2. For instance,
+// between_bb(SQ_C4, SQ_F7) will return a bitboard with squares D5, E6 and F7, but
+// between_bb(SQ_E6, SQ_F8) will return a bitboard with the square F8. This trick
+// allows to generate non-king evasion moves faster: the defending piece must either
+// interpose itself to cover the check or capture the checking piece.
+constexpr Bitboard between_bb(Square s1, Square s2) {
+    return BetweenBB[s1][s2];
+}
+
+// Returns a bitboard representing an entire line (from board edge
+// to board edge) that intersects the two given squares. If the given squares
+// are not on a same file/rank/diagonal, the function returns 0. For instance,
+// line_bb(SQ_C4, SQ_F7) will return a bitboard with the A2-G8 diagonal.
+constexpr Bitboard line_bb(Square s1, Square s2) {
+    return LineBB[s1][s2];
+}
+
 // Returns the pseudo attacks of the given piece type
 // assuming an empty board.
 template <PieceType Pt>
@@ -299,12 +528,51 @@ inline constexpr Bitboard attacks_bb(Square s, Bitboard occupied) {
 
     switch (Pt) {
         case BISHOP:
-        case ROOK: assert(Pt - BISHOP < 2); return Magics[s][Pt - BISHOP].attacks_bb(occupied);
+        case ROOK:
+            if consteval {
+                return Bitboards::sliding_attack(Pt, s, occupied);
+            }
+            switch (Bitboards::Sliders) {
+                case Bitboards::PEXT: return slider_attacks<Pt, Bitboards::PEXT>(s, occupied);
+                case Bitboards::MAGIC: return slider_attacks<Pt, Bitboards::MAGIC>(s, occupied);
+                default: return slider_attacks<Pt, Bitboards::HYPERBOLA>(s, occupied);
+            }
         case QUEEN: return attacks_bb<BISHOP>(s, occupied) | attacks_bb<ROOK>(s, occupied);
         default: return PseudoAttacks[Pt][s];
     }
 }
 
+// As above, but with the slider backend fixed by the caller. Loops over many lookups are
+// instantiated for each backend through with_sliders(), so that the backend is not branched on
+// per lookup.
+template <PieceType Pt, Bitboards::SliderBackend B>
+inline Bitboard attacks_bb(Square s, Bitboard occupied) {
+    assert((Pt != PAWN) && (is_ok(s)));
+
+    if constexpr (Pt == BISHOP || Pt == ROOK) {
+        return slider_attacks<Pt, B>(s, occupied);
+    } else if constexpr (Pt == QUEEN) {
+        return slider_attacks<BISHOP, B>(s, occupied) | slider_attacks<ROOK, B>(s, occupied);
+    } else {
+        return PseudoAttacks[Pt][s];
+    }
+}
+
+// Returns f.operator()<B>() for the slider backend B in use. With SLIDERS set this is a direct
+// call, otherwise a single branch on Bitboards::Sliders.
+template <typename F>
+inline decltype(auto) with_sliders(F&& f) {
+#ifdef SLIDERS
+    return f.template operator()<Bitboards::Sliders>();
+#else
+    switch (Bitboards::Sliders) {
+        case Bitboards::PEXT: return f.template operator()<Bitboards::PEXT>();
+        case Bitboards::MAGIC: return f.template operator()<Bitboards::MAGIC>();
+        default: return f.template operator()<Bitboards::HYPERBOLA>();
+    }
+#endif
+}
+
 // Returns the attacks by the given piece
 // assuming the board is occupied according to the passed Bitboard.
 // Sliding piece attacks do not continue passed an occupied square.
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <vector>
+#include "bitboard.h"
+#include "endgame.h"
+
+namespace Endgames {
+
+namespace {
+
+constexpr bool opposite_colors(Square s1, Square s2) {
+    return (int(file_of(s1)) + int(rank_of(s1)) + int(file_of(s2)) + int(rank_of(s2))) & 1;
+}
+
+// The pawn is on files A to D and ranks 2 to 7, 24 squares
+constexpr unsigned KPKIndexCount = 2 * 24 * SQUARE_NB * SQUARE_NB;
+
+// bit  0- 5: white king square
+// bit  6-11: black king square
+// bit    12: side to move
+// bit 13-14: pawn file, A to D
+// bit 15-17: RANK_7 minus the pawn rank
+constexpr unsigned kpk_index(Color stm, Square bksq, Square wksq, Square psq) {
+    return unsigned(wksq) | (unsigned(bksq) << 6) | (unsigned(stm) << 12) |
+           (unsigned(file_of(psq)) << 13) | (unsigned(RANK_7 - rank_of(psq)) << 15);
+}
+
+// Results are bit flags, so that the results of all moves can be combined with a bitwise or
+enum KPKResult : uint8_t {
+    INVALID = 0,
+    UNKNOWN = 1,
+    DRAW = 2,
+    WIN = 4,
+};
+
+struct KPKPosition {
+    KPKPosition() = default;
+    explicit KPKPosition(unsigned idx);
+    uint8_t classify(const std::vector<KPKPosition>& db);
+
+    Color stm{};
+    Square ksq[COLOR_NB]{};
+    Square psq{};
+    uint8_t result{};
+};
+
+// Positions decided without looking at the moves: illegal ones, immediate safe promotions,
+// stalemates and captures of an undefended pawn
+KPKPosition::KPKPosition(unsigned idx) {
+    ksq[WHITE] = Square(idx & 0x3F);
+    ksq[BLACK] = Square((idx >> 6) & 0x3F);
+    stm = Color((idx >> 12) & 0x01);
+    psq = make_square(File((idx >> 13) & 0x03), Rank(RANK_7 - ((idx >> 15) & 0x07)));
+
+    const Square promotion = psq + NORTH;
+
+    if (distance(ksq[WHITE], ksq[BLACK]) <= 1 || ksq[WHITE] == psq || ksq[BLACK] == psq ||
+        (stm == WHITE && (attacks_bb<PAWN>(psq, WHITE) & ksq[BLACK]))) {
+        result = INVALID;
+    } else if (stm == WHITE && rank_of(psq) == RANK_7 && ksq[WHITE] != promotion &&
+               (distance(ksq[BLACK], promotion) > 1 || distance(ksq[WHITE], promotion) == 1)) {
+        result = WIN;
+    } else if (stm == BLACK &&
+               (!(attacks_bb<KING>(ksq[BLACK]) &
+                  ~(attacks_bb<KING>(ksq[WHITE]) | attacks_bb<PAWN>(psq, WHITE))) ||
+                (attacks_bb<KING>(ksq[BLACK]) & ~attacks_bb<KING>(ksq[WHITE]) & psq))) {
+        result = DRAW;
+    } else {
+        result = UNKNOWN;
+    }
+}
+
+// A position is good for the side to move if one of its moves leads to a good position, bad if all
+// of them lead to bad ones, and unknown otherwise. Moves into illegal positions are ignored.
+uint8_t KPKPosition::classify(const std::vector<KPKPosition>& db) {
+    const KPKResult good = stm == WHITE ? WIN : DRAW;
+    const KPKResult bad = stm == WHITE ? DRAW : WIN;
+    uint8_t r = INVALID;
+
+    for (Bitboard b = attacks_bb<KING>(ksq[stm]); b;) {
+        const Square s = pop_lsb(b);
+        r |= stm == WHITE ? db[kpk_index(BLACK, ksq[BLACK], s, psq)].result
+                          : db[kpk_index(WHITE, s, ksq[WHITE], psq)].result;
+    }
+
+    if (stm == WHITE) {
+        if (rank_of(psq) < RANK_7) {
+            r |= db[kpk_index(BLACK, ksq[BLACK], ksq[WHITE], psq + NORTH)].result;
+        }
+        if (rank_of(psq) == RANK_2 && psq + NORTH != ksq[WHITE] && psq + NORTH != ksq[BLACK]) {
+            r |= db[kpk_index(BLACK, ksq[BLACK], ksq[WHITE], psq + 2 * NORTH)].result;
+        }
+    }
+
+    return result = r & good ? good : r & UNKNOWN ? UNKNOWN : bad;
+}
+
+// Retrograde analysis: positions are classified from their children until nothing changes, the
+// positions still unknown then are draws.
+std::bitset<KPKIndexCount> generate_kpk() {
+    std::vector<KPKPosition> db(KPKIndexCount);
+    for (unsigned idx = 0; idx < KPKIndexCount; ++idx) {
+        db[idx] = KPKPosition(idx);
+    }
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (KPKPosition& p : db) {
+            changed |= p.result == UNKNOWN && p.classify(db) != UNKNOWN;
+        }
+    }
+
+    std::bitset<KPKIndexCount> bitbase;
+    for (unsigned idx = 0; idx < KPKIndexCount; ++idx) {
+        bitbase[idx] = db[idx].result == WIN;
+    }
+    return bitbase;
+}
+
+// Mirrors sq so that strongSide is white and its single pawn is on files A to D
+Square normalize(const Position& pos, Color strongSide, Square sq) {
+    if (file_of(pos.square<PAWN>(strongSide)) >= FILE_E) {
+        sq = flip_file(sq);
+    }
+    return strongSide == WHITE ? sq : flip_rank(sq);
+}
+
+}  // namespace
+
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm) {
+    assert(file_of(wpsq) <= FILE_D);
+
+    static const std::bitset<KPKIndexCount> bitbase = generate_kpk();
+    return bitbase[kpk_index(stm, bksq, wksq, wpsq)];
+}
+
+Value kpk(const Position& pos, Color strongSide) {
+    const Square wksq = normalize(pos, strongSide, pos.square<KING>(strongSide));
+    const Square bksq = normalize(pos, strongSide, pos.square<KING>(~strongSide));
+    const Square psq = normalize(pos, strongSide, pos.square<PAWN>(strongSide));
+    const Color us = strongSide == pos.side_to_move() ? WHITE : BLACK;
+
+    if (!probe_kpk(wksq, psq, bksq, us)) {
+        return VALUE_DRAW;
+    }
+
+    const Value result = VALUE_KNOWN_WIN + PawnValue + rank_of(psq);
+    return strongSide == pos.side_to_move() ? result : -result;
+}
+
+Value kbnk(const Position& pos, Color strongSide) {
+    const Square strongKing = pos.square<KING>(strongSide);
+    const Square weakKing = pos.square<KING>(~strongSide);
+    const Square bishop = pos.square<BISHOP>(strongSide);
+
+    // The distance of the weak king from the A8-H1 diagonal, largest in the A1 and H8 corners.
+    // With a light-squared bishop the board is mirrored, so that the bishop's corners count.
+    const Square s = opposite_colors(bishop, SQ_A1) ? flip_file(weakKing) : weakKing;
+    const int corner = std::abs(7 - rank_of(s) - file_of(s));
+
+    const Value result = VALUE_KNOWN_WIN + KnightValue + BishopValue + 60 * corner +
+                         20 * (7 - distance(strongKing, weakKing));
+    return strongSide == pos.side_to_move() ? result : -result;
+}
+
+// Won when the strong king stops the pawn or the weak king is too far from both the pawn and the
+// rook, drawish when the weak king supports a far advanced pawn the strong king cannot reach.
+// Otherwise the race of the kings decides.
+Value krkp(const Position& pos, Color strongSide) {
+    const Color weakSide = ~strongSide;
+    const Square strongKing = relative_square(strongSide, pos.square<KING>(strongSide));
+    const Square weakKing = relative_square(strongSide, pos.square<KING>(weakSide));
+    const Square rook = relative_square(strongSide, pos.square<ROOK>(strongSide));
+    const Square pawn = relative_square(strongSide, pos.square<PAWN>(weakSide));
+    const Square promotion = make_square(file_of(pawn), RANK_1);
+    Value result;
+
+    if (forward_file_bb(WHITE, strongKing) & pawn) {
+        result = RookValue - distance(strongKing, pawn);
+    } else if (distance(weakKing, pawn) >= 3 + (pos.side_to_move() == weakSide) &&
+               distance(weakKing, rook) >= 3) {
+        result = RookValue - distance(strongKing, pawn);
+    } else if (rank_of(weakKing) <= RANK_3 && distance(weakKing, pawn) == 1 &&
+               rank_of(strongKing) >= RANK_4 &&
+               distance(strongKing, pawn) > 2 + (pos.side_to_move() == strongSide)) {
+        result = 30 - 3 * distance(strongKing, pawn);
+    } else {
+        result = 80 - 3 * (distance(strongKing, pawn + SOUTH) - distance(weakKing, pawn + SOUTH) -
+                           distance(pawn, promotion));
+    }
+
+    return strongSide == pos.side_to_move() ? result : -result;
+}
+
+Value insufficient_material(const Position&, Color) {
+    return VALUE_DRAW;
+}
+
+int kbpsk(const Position& pos, Color strongSide) {
+    const Bitboard pawns = pos.pieces<PAWN>(strongSide);
+    const Square promotion = relative_square(strongSide, make_square(file_of(lsb(pawns)), RANK_8));
+
+    if ((!(pawns & ~FileABB) || !(pawns & ~FileHBB)) &&
+        opposite_colors(promotion, pos.square<BISHOP>(strongSide)) &&
+        distance(promotion, pos.square<KING>(~strongSide)) <= 1) {
+        return ScaleFactorDraw;
+    }
+
+    return ScaleFactorNone;
+}
+
+}  // namespace Endgames
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "position.h"
+#include "types.h"
+
+namespace Endgames {
+
+// The endgame value of a position is scaled by a factor in 1/64ths
+constexpr int ScaleFactorDraw = 0;
+constexpr int ScaleFactorNormal = 64;
+// Returned by a scaling function when the position is not a special case of its ending
+constexpr int ScaleFactorNone = 255;
+
+// Evaluates a position of a recognized ending from the point of view of the side to move.
+// strongSide is the side with the material advantage.
+using EvalFunction = Value (*)(const Position& pos, Color strongSide);
+// Returns the scale factor of the endgame value when strongSide is ahead, or ScaleFactorNone.
+using ScaleFunction = int (*)(const Position& pos, Color strongSide);
+
+// King and pawn against king, exact from the bitbase
+Value kpk(const Position& pos, Color strongSide);
+// King, bishop and knight against king: the weak king is driven to a corner of the bishop's color
+Value kbnk(const Position& pos, Color strongSide);
+// King and rook against king and pawn
+Value krkp(const Position& pos, Color strongSide);
+// Neither side has the material to force checkmate
+Value insufficient_material(const Position& pos, Color strongSide);
+
+// King, bishop and rook pawns against king: a draw when the bishop does not control the promotion
+// square and the defending king is next to it
+int kbpsk(const Position& pos, Color strongSide);
+
+/// Returns whether white wins the KPK position with the given side to move. The pawn must be on
+/// files A to D. The bitbase is generated on the first call.
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm);
+
+}  // namespace Endgames
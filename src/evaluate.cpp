@@ -0,0 +1,51 @@
+#include <algorithm>
+#include "evaluate.h"
+
+namespace Eval {
+
+int game_phase(const Position& pos) {
+    const int phase = pos.count<KNIGHT>() + pos.count<BISHOP>() + 2 * pos.count<ROOK>() +
+                      4 * pos.count<QUEEN>();
+
+    // Promotions can push the count past the initial material
+    return std::min(phase, MaxPhase);
+}
+
+namespace {
+
+Value evaluate_with(const Position& pos, Pawns::Entry& pe, const Material::Entry& me) {
+    const Score score = pos.psq_score() + me.imbalance() + pe.pawn_score(WHITE) -
+                        pe.pawn_score(BLACK) + pe.king_shelter(pos, WHITE) -
+                        pe.king_shelter(pos, BLACK);
+    const int phase = me.game_phase();
+    const Color strongSide = eg_value(score) > VALUE_DRAW ? WHITE : BLACK;
+    const int sf = me.scale_factor(pos, strongSide);
+    const Value eg = eg_value(score) * sf / Endgames::ScaleFactorNormal;
+    const Value v = (mg_value(score) * phase + eg * (MaxPhase - phase)) / MaxPhase;
+
+    return pos.side_to_move() == WHITE ? v : -v;
+}
+
+}  // namespace
+
+Value evaluate(const Position& pos) {
+    Material::Entry me;
+    Material::evaluate(pos, me);
+    if (me.specialized_eval_exists()) {
+        return me.evaluate(pos);
+    }
+
+    Pawns::Entry pe;
+    Pawns::evaluate(pos, pe);
+    return evaluate_with(pos, pe, me);
+}
+
+Value evaluate(const Position& pos, Pawns::Table& pawns, Material::Table& material) {
+    const Material::Entry* me = material.probe(pos);
+    if (me->specialized_eval_exists()) {
+        return me->evaluate(pos);
+    }
+    return evaluate_with(pos, *pawns.probe(pos), *me);
+}
+
+}  // namespace Eval
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "material.h"
+#include "pawns.h"
+#include "position.h"
+#include "types.h"
+
+namespace Eval {
+
+// The game phase goes from MaxPhase with all pieces on the board down to 0 when only pawns and
+// kings are left. Minor pieces count 1, rooks 2 and queens 4.
+constexpr int MaxPhase = 24;
+
+int game_phase(const Position& pos);
+
+/// Returns the static evaluation of the position from the point of view of the side to move: the
+/// incrementally updated material and piece-square score plus the pawn structure and the material
+/// imbalance, interpolated between its middlegame and endgame values by the game phase. Recognized
+/// endings are evaluated by their own functions instead.
+Value evaluate(const Position& pos);
+/// Same as above, with the pawn structure and the material entry taken from the tables when they
+/// are already there.
+Value evaluate(const Position& pos, Pawns::Table& pawns, Material::Table& material);
+
+}  // namespace Eval
@@ -50,6 +50,7 @@ void ChessGUI::loop() {
         while (SDL_PollEvent(&event)) {
             handle_event(event);
         }
+        update();
         render();
     }
 }
@@ -60,6 +61,8 @@ void ChessGUI::handle_event(SDL_Event e) {
         case SDL_KEYDOWN:
             if (e.key.keysym.sym == SDLK_ESCAPE) {
                 isRunning = false;
+            } else if (e.key.keysym.sym == SDLK_SPACE) {
+                start_engine();
             }
             break;
         case SDL_MOUSEBUTTONDOWN: handle_press(e.button); break;
@@ -70,7 +73,25 @@ void ChessGUI::handle_event(SDL_Event e) {
     }
 }
 
-void ChessGUI::update() {}
+void ChessGUI::update() {
+    if (engineMoving && !searcher.searching()) {
+        engineMoving = false;
+        if (Move m = searcher.result().best_move()) {
+            make_move(m);
+        }
+    }
+}
+
+void ChessGUI::start_engine() {
+    if (engineMoving || MoveList<LEGAL>(position).size() == 0 || position.is_draw(0)) {
+        return;
+    }
+
+    unselect();
+    close_selector();
+    engineMoving = true;
+    searcher.start(position, {.time = ENGINE_MOVE_TIME});
+}
 
 void ChessGUI::render() {
     clear(renderer, Rendering::DARK_BROWN);
@@ -103,12 +124,12 @@ void ChessGUI::render() {
 }
 
 void ChessGUI::handle_press(SDL_MouseButtonEvent e) {
-    if (e.button != SDL_BUTTON_LEFT)
+    if (e.button != SDL_BUTTON_LEFT || engineMoving)
         return;
 
     if (promotionSelector.has_value()) {
         if (promotionSelector->contains(e.x, e.y))
-            position.make_move(promotionSelector->move_on(e.x, e.y));
+            make_move(promotionSelector->move_on(e.x, e.y));
         close_selector();
     }
 
@@ -127,7 +148,7 @@ void ChessGUI::handle_press(SDL_MouseButtonEvent e) {
 }
 
 void ChessGUI::handle_release(SDL_MouseButtonEvent e) {
-    if (e.button != SDL_BUTTON_LEFT)
+    if (e.button != SDL_BUTTON_LEFT || engineMoving)
         return;
 
     if (!board.contains(e.x, e.y)) {
@@ -166,7 +187,7 @@ bool ChessGUI::try_move(Move move) {
 
     // Early exit on promotion selections.
     if (move.type_of() == PROMOTION && legalMoves.contains(move)) {
-        position.make_move(move);
+        make_move(move);
         return true;
     }
 
@@ -176,7 +197,7 @@ bool ChessGUI::try_move(Move move) {
 
     // En passant, castling and normal moves.
     if (moves.size() == 1) {
-        position.make_move(moves.front());
+        make_move(moves.front());
         return true;
     }
 
@@ -189,6 +210,10 @@ bool ChessGUI::try_move(Move move) {
     return false;
 }
 
+void ChessGUI::make_move(Move m) {
+    position.make_move(m, states.emplace_back());
+}
+
 void ChessGUI::select(Square s) {
     selected = {s, position.piece_on(s)};
 }
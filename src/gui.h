@@ -4,14 +4,18 @@
 #include <SDL2/SDL_rect.h>
 #include <SDL2/SDL_render.h>
 #include <array>
+#include <chrono>
 #include <optional>
+#include <thread>
 #include <vector>
 #include "position.h"
 #include "rendering.h"
+#include "search.h"
 #include "types.h"
 
 constexpr int BOARD_MARGIN = 20;
 constexpr int MIN_SIZE = 128;
+constexpr std::chrono::milliseconds ENGINE_MOVE_TIME{1000};
 
 struct Selected {
     Square square;
@@ -75,11 +79,16 @@ class ChessGUI {
     /// Checks if the move is legal, before making the move on the position.
     /// Returns true if the move was made.
     bool try_move(Move m);
+    /// Makes the move on the position, keeping its state alive for the rest of the game.
+    void make_move(Move m);
     void select(Square s);
     void unselect();
     void open_selector(Square from, Square to);
     void close_selector();
 
+    /// Starts a search for the side to move, its best move is made by update() once it is done.
+    void start_engine();
+
     /// Returns the legal squares to move to from the given square.
     std::vector<Square> legal_squares_from(Square from) const;
 
@@ -91,9 +100,12 @@ class ChessGUI {
 
     Board board;
     Position position{};
+    StateList states{};
     Color perspective = WHITE;
     std::optional<Selected> selected = std::nullopt;
     std::optional<PromotionSelector> promotionSelector = std::nullopt;
+    Search::Searcher searcher{std::thread::hardware_concurrency()};
+    bool engineMoving = false;
 
     SDL_Window* window;
     SDL_Renderer* renderer;
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include "evaluate.h"
+#include "material.h"
+
+namespace Material {
+
+namespace {
+
+constexpr Score S(int mg, int eg) {
+    return make_score(mg, eg);
+}
+
+constexpr Score BishopPair = S(30, 50);
+// Per pawn of the side above 5: knights gain with the pawns, rooks with the open lines
+constexpr int KnightPawn = 3;
+constexpr int RookPawn = 6;
+
+template <Color Us>
+int non_pawn_material(const Position& pos) {
+    return KnightValue * pos.count<KNIGHT>(Us) + BishopValue * pos.count<BISHOP>(Us) +
+           RookValue * pos.count<ROOK>(Us) + QueenValue * pos.count<QUEEN>(Us);
+}
+
+template <Color Us>
+Score imbalance(const Position& pos) {
+    const int pawns = pos.count<PAWN>(Us) - 5;
+    Score score = SCORE_ZERO;
+
+    if (pos.count<BISHOP>(Us) >= 2) {
+        score += BishopPair;
+    }
+    const int v = (KnightPawn * pos.count<KNIGHT>(Us) - RookPawn * pos.count<ROOK>(Us)) * pawns;
+    return score + make_score(v, v);
+}
+
+// Only the king, or the king and a single minor piece
+template <Color Us>
+bool at_most_one_minor(const Position& pos) {
+    return pos.count<ALL_PIECES>(Us) - pos.count<KNIGHT>(Us) - pos.count<BISHOP>(Us) == 1 &&
+           pos.count<KNIGHT>(Us) + pos.count<BISHOP>(Us) <= 1;
+}
+
+bool is_insufficient_material(const Position& pos) {
+    if (pos.count<PAWN>() || pos.count<ROOK>() || pos.count<QUEEN>()) {
+        return false;
+    }
+    if (at_most_one_minor<WHITE>(pos) && at_most_one_minor<BLACK>(pos)) {
+        return true;
+    }
+
+    // Two knights cannot force checkmate of a bare king
+    for (Color c : {WHITE, BLACK}) {
+        if (pos.count<ALL_PIECES>(~c) == 1 && pos.count<KNIGHT>(c) == 2 &&
+            pos.count<ALL_PIECES>(c) == 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The side c against a bare king, with only the given pieces besides its king
+bool is_ending(const Position& pos, Color c, int pawns, int knights, int bishops, int rooks) {
+    return pos.count<ALL_PIECES>(~c) == 1 && pos.count(make_piece(c, PAWN)) == pawns &&
+           pos.count(make_piece(c, KNIGHT)) == knights &&
+           pos.count(make_piece(c, BISHOP)) == bishops &&
+           pos.count(make_piece(c, ROOK)) == rooks &&
+           pos.count<ALL_PIECES>(c) == 1 + pawns + knights + bishops + rooks;
+}
+
+}  // namespace
+
+void evaluate(const Position& pos, Entry& e) {
+    e.key = pos.material_key();
+    e.gamePhase = Eval::game_phase(pos);
+    e.imbalanceScore = imbalance<WHITE>(pos) - imbalance<BLACK>(pos);
+    e.evaluationFunction = nullptr;
+    e.strongSide = WHITE;
+    e.scalingFunction[WHITE] = e.scalingFunction[BLACK] = nullptr;
+    e.factor[WHITE] = e.factor[BLACK] = Endgames::ScaleFactorNormal;
+
+    if (is_insufficient_material(pos)) {
+        e.evaluationFunction = &Endgames::insufficient_material;
+        return;
+    }
+
+    for (Color c : {WHITE, BLACK}) {
+        if (is_ending(pos, c, 1, 0, 0, 0)) {
+            e.evaluationFunction = &Endgames::kpk;
+        } else if (is_ending(pos, c, 0, 1, 1, 0)) {
+            e.evaluationFunction = &Endgames::kbnk;
+        } else if (pos.count<ALL_PIECES>(c) == 2 && pos.count<ROOK>(c) == 1 &&
+                   pos.count<ALL_PIECES>(~c) == 2 && pos.count<PAWN>(~c) == 1) {
+            e.evaluationFunction = &Endgames::krkp;
+        }
+
+        if (e.evaluationFunction) {
+            e.strongSide = c;
+            return;
+        }
+    }
+
+    const int npm[COLOR_NB] = {non_pawn_material<WHITE>(pos), non_pawn_material<BLACK>(pos)};
+
+    for (Color c : {WHITE, BLACK}) {
+        if (pos.count<ALL_PIECES>(c) - pos.count<PAWN>(c) == 2 && pos.count<BISHOP>(c) == 1 &&
+            pos.count<PAWN>(c) && pos.count<ALL_PIECES>(~c) == 1) {
+            e.scalingFunction[c] = &Endgames::kbpsk;
+        }
+
+        // Without pawns, a small material advantage is hard to convert
+        if (!pos.count<PAWN>(c) && npm[c] - npm[~c] <= BishopValue) {
+            e.factor[c] = npm[c] < RookValue ? Endgames::ScaleFactorDraw
+                          : npm[~c] <= BishopValue ? 4
+                                                   : 14;
+        }
+    }
+}
+
+Entry* Table::probe(const Position& pos) {
+    Entry* e = &entries[pos.material_key() & (Size - 1)];
+    if (e->key != pos.material_key()) {
+        evaluate(pos, *e);
+    }
+    return e;
+}
+
+void Table::clear() {
+    std::fill_n(entries.get(), Size, Entry{});
+}
+
+}  // namespace Material
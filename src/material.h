@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "endgame.h"
+#include "position.h"
+#include "types.h"
+
+namespace Material {
+
+// Everything the evaluation derives from the piece counts alone: the game phase, the imbalance
+// between the piece types, and the functions of a recognized ending.
+struct Entry {
+    int game_phase() const { return gamePhase; }
+    // From white's point of view
+    Score imbalance() const { return imbalanceScore; }
+
+    bool specialized_eval_exists() const { return evaluationFunction != nullptr; }
+    Value evaluate(const Position& pos) const { return evaluationFunction(pos, strongSide); }
+
+    // The factor in 1/64ths applied to the endgame value when color c is ahead
+    int scale_factor(const Position& pos, Color c) const {
+        const int sf = scalingFunction[c] ? scalingFunction[c](pos, c) : Endgames::ScaleFactorNone;
+        return sf != Endgames::ScaleFactorNone ? sf : factor[c];
+    }
+
+    Key key;
+    int gamePhase;
+    Score imbalanceScore;
+    Endgames::EvalFunction evaluationFunction;
+    Color strongSide;
+    Endgames::ScaleFunction scalingFunction[COLOR_NB];
+    uint8_t factor[COLOR_NB];
+};
+
+/// Fills e from the piece counts of pos, without a table.
+void evaluate(const Position& pos, Entry& e);
+
+// A material hash table keyed by the material key of the position. Only captures and promotions
+// change it, so nearly every probe hits. It is not thread safe, every search thread owns one.
+class Table {
+   public:
+    static constexpr size_t Size = 1 << 13;
+
+    Table() : entries(std::make_unique<Entry[]>(Size)) { clear(); }
+
+    /// Returns the entry of the material of pos, evaluating it on a miss. The previous entry at
+    /// its index is replaced.
+    Entry* probe(const Position& pos);
+    void clear();
+
+   private:
+    std::unique_ptr<Entry[]> entries;
+};
+
+}  // namespace Material
@@ -11,9 +11,14 @@ int generate_nodes(Position& pos, int depth) {
         return 1;
     }
 
+    if (depth == 1) {
+        return MoveList<LEGAL>(pos).size();
+    }
+
+    StateInfo st;
     int num_positions{0};
     for (const auto& m : MoveList<LEGAL>(pos)) {
-        pos.make_move(m);
+        pos.make_move(m, st);
         num_positions += generate_nodes(pos, depth - 1);
         pos.unmake_move(m);
     }
@@ -39,7 +44,7 @@ inline Move* splat_pawn_moves(Move* moveList, Bitboard to_bb) {
 
 template <GenType Type, Direction D, bool Enemy>
 Move* make_promotions(Move* moveList, [[maybe_unused]] Square to) {
-    constexpr bool all = Type == EVASIONS || Type == NON_EVASIONS;
+    constexpr bool all = Type == EVASIONS || Type == NON_EVASIONS || Type == LEGAL;
 
     if constexpr (Type == TACTICALS || all) {
         *moveList++ = Move::make<PROMOTION>(to - D, to, QUEEN);
@@ -54,8 +59,11 @@ Move* make_promotions(Move* moveList, [[maybe_unused]] Square to) {
     return moveList;
 }
 
+// Generates the moves of the given pawns. With Type == LEGAL the pawns are assumed not to be
+// pinned against anything outside target, every move lands on target and en passant captures
+// are left to the caller.
 template <GenType Type, Color Us>
-Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target) {
+Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target, Bitboard pawns) {
     constexpr Color Them = ~Us;
     constexpr Bitboard RelRank7BB = Us == WHITE ? Rank7BB : Rank2BB;
     constexpr Bitboard RelRank3BB = Us == WHITE ? Rank3BB : Rank6BB;
@@ -63,17 +71,19 @@ Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target)
     constexpr Direction UpRight = Us == WHITE ? NORTH_EAST : SOUTH_WEST;
     constexpr Direction UpLeft = Us == WHITE ? NORTH_WEST : SOUTH_EAST;
 
-    Bitboard enemies = Type == EVASIONS ? pos.checkers() : pos.pieces(Them);
+    Bitboard enemies = Type == EVASIONS ? pos.checkers()
+                       : Type == LEGAL  ? pos.pieces(Them) & target
+                                        : pos.pieces(Them);
     Bitboard emptySquares = ~pos.pieces();
 
-    Bitboard pawnsOn7 = pos.pieces<PAWN>(Us) & RelRank7BB;
-    Bitboard pawnsNotOn7 = pos.pieces<PAWN>(Us) & ~RelRank7BB;
+    Bitboard pawnsOn7 = pawns & RelRank7BB;
+    Bitboard pawnsNotOn7 = pawns & ~RelRank7BB;
 
     if constexpr (Type != TACTICALS) {
         Bitboard b1 = shift<Up>(pawnsNotOn7) & emptySquares;
         Bitboard b2 = shift<Up>(b1 & RelRank3BB) & emptySquares;
 
-        if constexpr (Type == EVASIONS) {
+        if constexpr (Type == EVASIONS || Type == LEGAL) {
             b1 &= target;
             b2 &= target;
         }
@@ -88,7 +98,7 @@ Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target)
         Bitboard b2 = shift<UpLeft>(pawnsOn7) & enemies;
         Bitboard b3 = shift<Up>(pawnsOn7) & emptySquares;
 
-        if constexpr (Type == EVASIONS) {
+        if constexpr (Type == EVASIONS || Type == LEGAL) {
             b3 &= target;
         }
 
@@ -106,14 +116,14 @@ Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target)
     }
 
     // Standard and en passant captures
-    if constexpr (Type == TACTICALS || Type == EVASIONS || Type == NON_EVASIONS) {
+    if constexpr (Type != QUIETS) {
         Bitboard b1 = shift<UpRight>(pawnsNotOn7) & enemies;
         Bitboard b2 = shift<UpLeft>(pawnsNotOn7) & enemies;
 
         moveList = splat_pawn_moves<UpRight>(moveList, b1);
         moveList = splat_pawn_moves<UpLeft>(moveList, b2);
 
-        if (pos.ep_square() != SQ_NONE) {
+        if (Type != LEGAL && pos.ep_square() != SQ_NONE) {
             assert(rank_of(pos.ep_square()) == relative_rank(Us, RANK_6));
 
             // An en passant capture cannot resolve a discovered check
@@ -132,17 +142,16 @@ Move* generate_pawn_moves(const Position& pos, Move* moveList, Bitboard target)
     return moveList;
 }
 
-template <PieceType Pt, Color Us>
-Move* generate_moves(const Position& pos, Move* moveList, Bitboard target) {
+template <PieceType Pt, Bitboards::SliderBackend B>
+Move* generate_moves(const Position& pos, Move* moveList, Bitboard pieces, Bitboard target) {
     static_assert(Pt != PAWN && Pt != KING, "Unsupported type in generate_moves()");
 
-    Bitboard pieces = pos.pieces<Pt>(Us);
     Bitboard occupied = pos.pieces();
 
     while (pieces) {
         Square from = pop_lsb(pieces);
 
-        Bitboard to_bb = attacks_bb(Pt, from, occupied) & target;
+        Bitboard to_bb = attacks_bb<Pt, B>(from, occupied) & target;
 
         moveList = splat_moves(moveList, from, to_bb);
     }
@@ -150,9 +159,9 @@ Move* generate_moves(const Position& pos, Move* moveList, Bitboard target) {
     return moveList;
 }
 
-template <GenType Type, Color Us>
+template <GenType Type, Color Us, Bitboards::SliderBackend B>
 Move* generate_all(const Position& pos, Move* moveList) {
-    static_assert(Type != LEGAL, "Unsupported type in generate_all()");
+    static_assert(Type != LEGAL && Type != FILTERED_LEGAL, "Unsupported type in generate_all()");
 
     const Square ksq = pos.square<KING>(Us);
     Bitboard target{};
@@ -163,11 +172,11 @@ Move* generate_all(const Position& pos, Move* moveList) {
                  : Type == TACTICALS    ? pos.pieces(~Us)
                                         : ~pos.pieces();  // Quiets
 
-        moveList = generate_pawn_moves<Type, Us>(pos, moveList, target);
-        moveList = generate_moves<KNIGHT, Us>(pos, moveList, target);
-        moveList = generate_moves<BISHOP, Us>(pos, moveList, target);
-        moveList = generate_moves<ROOK, Us>(pos, moveList, target);
-        moveList = generate_moves<QUEEN, Us>(pos, moveList, target);
+        moveList = generate_pawn_moves<Type, Us>(pos, moveList, target, pos.pieces<PAWN>(Us));
+        moveList = generate_moves<KNIGHT, B>(pos, moveList, pos.pieces<KNIGHT>(Us), target);
+        moveList = generate_moves<BISHOP, B>(pos, moveList, pos.pieces<BISHOP>(Us), target);
+        moveList = generate_moves<ROOK, B>(pos, moveList, pos.pieces<ROOK>(Us), target);
+        moveList = generate_moves<QUEEN, B>(pos, moveList, pos.pieces<QUEEN>(Us), target);
     }
 
     Bitboard b = attacks_bb<KING>(ksq) & (Type == EVASIONS ? ~pos.pieces(Us) : target);
@@ -189,13 +198,15 @@ Move* generate_all(const Position& pos, Move* moveList) {
 // Returns a pointer to the end of the move list.
 template <GenType Type>
 Move* generate(const Position& pos, Move* moveList) {
-    static_assert(Type != LEGAL, "Unsupported type in generate()");
+    static_assert(Type != LEGAL && Type != FILTERED_LEGAL, "Unsupported type in generate()");
     assert((Type == EVASIONS) == bool(pos.checkers()));
 
     Color us = pos.side_to_move();
 
-    return us == WHITE ? generate_all<Type, WHITE>(pos, moveList)
-                       : generate_all<Type, BLACK>(pos, moveList);
+    return with_sliders([&]<Bitboards::SliderBackend B>() {
+        return us == WHITE ? generate_all<Type, WHITE, B>(pos, moveList)
+                           : generate_all<Type, BLACK, B>(pos, moveList);
+    });
 }
 
 // Explicit template instantiations
@@ -204,10 +215,113 @@ template Move* generate<QUIETS>(const Position&, Move*);
 template Move* generate<EVASIONS>(const Position&, Move*);
 template Move* generate<NON_EVASIONS>(const Position&, Move*);
 
+// Returns the squares attacked by the pieces of color C, with sliders seeing through everything
+// not in occupied.
+template <Color C, Bitboards::SliderBackend B>
+Bitboard attacked_by(const Position& pos, Bitboard occupied) {
+    Bitboard attacks = pawn_attacks_bb<C>(pos.pieces<PAWN>(C)) |
+                       attacks_bb<KING>(pos.square<KING>(C));
+
+    for (Bitboard b = pos.pieces<KNIGHT>(C); b;) {
+        attacks |= attacks_bb<KNIGHT>(pop_lsb(b));
+    }
+
+    for (Bitboard b = pos.pieces<BISHOP, QUEEN>(C); b;) {
+        attacks |= attacks_bb<BISHOP, B>(pop_lsb(b), occupied);
+    }
+
+    for (Bitboard b = pos.pieces<ROOK, QUEEN>(C); b;) {
+        attacks |= attacks_bb<ROOK, B>(pop_lsb(b), occupied);
+    }
+
+    return attacks;
+}
+
+// Generates the legal moves directly: the king avoids every attacked square, pinned pieces only
+// move along their pin line, and in check the other pieces must block or capture the checker.
+template <Color Us, Bitboards::SliderBackend B>
+Move* generate_legal(const Position& pos, Move* moveList) {
+    constexpr Color Them = ~Us;
+    constexpr Direction Up = pawn_push(Us);
+
+    const Square ksq = pos.square<KING>(Us);
+    const Bitboard checkers = pos.checkers();
+
+    // The king is removed from the occupancy, so it cannot step back along a checking ray
+    const Bitboard danger = attacked_by<Them, B>(pos, pos.pieces() ^ ksq);
+
+    moveList = splat_moves(moveList, ksq, attacks_bb<KING>(ksq) & ~pos.pieces(Us) & ~danger);
+
+    if (more_than_one(checkers)) {
+        return moveList;
+    }
+
+    const Bitboard target = checkers ? between_bb(ksq, lsb(checkers)) : ~pos.pieces(Us);
+    const Bitboard pinned = pos.blockers_for_king(Us) & pos.pieces(Us);
+
+    moveList = generate_pawn_moves<LEGAL, Us>(pos, moveList, target, pos.pieces<PAWN>(Us) & ~pinned);
+    moveList = generate_moves<KNIGHT, B>(pos, moveList, pos.pieces<KNIGHT>(Us) & ~pinned, target);
+    moveList = generate_moves<BISHOP, B>(pos, moveList, pos.pieces<BISHOP>(Us) & ~pinned, target);
+    moveList = generate_moves<ROOK, B>(pos, moveList, pos.pieces<ROOK>(Us) & ~pinned, target);
+    moveList = generate_moves<QUEEN, B>(pos, moveList, pos.pieces<QUEEN>(Us) & ~pinned, target);
+
+    // Pinned pieces stay on the line through the king. In check the line only meets the target
+    // when the "pinner" is hidden behind the checker itself. A pinned knight can never move.
+    for (Bitboard b = pinned & ~pos.pieces<KNIGHT>(); b;) {
+        Square from = pop_lsb(b);
+        Bitboard line = target & line_bb(ksq, from);
+
+        if (type_of(pos.piece_on(from)) == PAWN) {
+            moveList = generate_pawn_moves<LEGAL, Us>(pos, moveList, line, square_bb(from));
+        } else {
+            moveList = splat_moves(moveList, from,
+                                   attacks_bb(type_of(pos.piece_on(from)), from, pos.pieces()) & line);
+        }
+    }
+
+    // En passant captures remove two pieces from a line, so they are verified against the
+    // resulting occupancy. This also covers checks by the captured pawn.
+    if (Square ep = pos.ep_square(); ep != SQ_NONE) {
+        Square capsq = ep - Up;
+
+        for (Bitboard b = pos.pieces<PAWN>(Us) & attacks_bb<PAWN>(ep, Them); b;) {
+            Square from = pop_lsb(b);
+            Bitboard occupied = (pos.pieces() ^ from ^ capsq) | ep;
+
+            if (!(attacks_bb<ROOK, B>(ksq, occupied) & pos.pieces<ROOK, QUEEN>(Them)) &&
+                !(attacks_bb<BISHOP, B>(ksq, occupied) & pos.pieces<BISHOP, QUEEN>(Them))) {
+                *moveList++ = Move::make<EN_PASSANT>(from, ep);
+            }
+        }
+    }
+
+    if (!checkers && pos.can_castle(Us & ANY_CASTLING)) {
+        for (CastlingRights cr : {Us & KING_SIDE, Us & QUEEN_SIDE}) {
+            Square kto = relative_square(Us, cr & KING_SIDE ? SQ_G1 : SQ_C1);
+
+            if (pos.can_castle(cr) && !pos.castling_impeded(cr) && !(between_bb(ksq, kto) & danger))
+                *moveList++ = Move::make<CASTLING>(ksq, pos.castling_rook_square(cr));
+        }
+    }
+
+    return moveList;
+}
+
 // generate<LEGAL> generates all the legal moves in the given position
 
 template <>
 Move* generate<LEGAL>(const Position& pos, Move* moveList) {
+    return with_sliders([&]<Bitboards::SliderBackend B>() {
+        return pos.side_to_move() == WHITE ? generate_legal<WHITE, B>(pos, moveList)
+                                           : generate_legal<BLACK, B>(pos, moveList);
+    });
+}
+
+// generate<FILTERED_LEGAL> generates all the legal moves by filtering the pseudo-legal ones with
+// Position::legal(). It is kept as a reference implementation for generate<LEGAL>.
+
+template <>
+Move* generate<FILTERED_LEGAL>(const Position& pos, Move* moveList) {
     Color us = pos.side_to_move();
     Bitboard pinned = pos.blockers_for_king(us) & pos.pieces(us);
     Square ksq = pos.square<KING>(us);
@@ -14,6 +14,7 @@ enum GenType {
     EVASIONS,
     NON_EVASIONS,
     LEGAL,
+    FILTERED_LEGAL,
 };
 
 template <GenType>
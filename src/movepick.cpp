@@ -0,0 +1,178 @@
+#include "movepick.h"
+#include <cassert>
+#include <climits>
+#include "psqt.h"
+
+namespace {
+
+enum Stage {
+    MAIN_TT,
+    CAPTURE_INIT,
+    GOOD_CAPTURE,
+    KILLER,
+    QUIET_INIT,
+    QUIET,
+    BAD_CAPTURE,
+
+    EVASION_TT,
+    EVASION_INIT,
+    EVASION,
+
+    QCAPTURE_INIT,
+    QCAPTURE,
+};
+
+// Evasions capturing the checker come before the others, which are ordered as quiet moves
+constexpr int EvasionCaptureBonus = 1 << 16;
+
+// Quiet moves losing piece-square score are not worth sorting, they are mostly searched late and
+// reduced anyway.
+constexpr int QuietSortLimit = 0;
+
+// Sorts the moves scoring at least limit to the front in decreasing order, the others follow in
+// no particular order. Cheaper than a full sort when most moves are below the limit.
+void partial_insertion_sort(ExtMove* begin, ExtMove* end, int limit) {
+    for (ExtMove *sortedEnd = begin, *p = begin + 1; p < end; ++p) {
+        if (p->value >= limit) {
+            ExtMove tmp = *p, *q;
+            *p = *++sortedEnd;
+            for (q = sortedEnd; q != begin && (q - 1)->value < tmp.value; --q) {
+                *q = *(q - 1);
+            }
+            *q = tmp;
+        }
+    }
+}
+
+// Most valuable victim, then least valuable attacker: piece values differ by more than the piece
+// types, so the victim always decides first. A promotion counts as capturing its gain.
+int mvv_lva(const Position& pos, Move m) {
+    Value victim =
+        m.type_of() == EN_PASSANT ? PawnValue : PieceValue[type_of(pos.piece_on(m.to_sq()))];
+    if (m.type_of() == PROMOTION) {
+        victim += PieceValue[m.promotion_type()] - PawnValue;
+    }
+    return victim - int(type_of(pos.moved_piece(m)));
+}
+
+// The middlegame piece-square gain of the move for the side making it
+int psq_gain(const Position& pos, Move m) {
+    const Piece pc = pos.moved_piece(m);
+    const Value gain = mg_value(PSQT::psq[pc][m.to_sq()] - PSQT::psq[pc][m.from_sq()]);
+    return pos.side_to_move() == WHITE ? gain : -gain;
+}
+
+}  // namespace
+
+MovePicker::MovePicker(const Position& p, Move ttm, const std::array<Move, 2>& killerMoves)
+    : pos(p),
+      ttMove(ttm && p.pseudo_legal(ttm) ? ttm : Move::none()),
+      killers(killerMoves),
+      stage((p.checkers() ? EVASION_TT : MAIN_TT) + !ttMove) {}
+
+MovePicker::MovePicker(const Position& p)
+    : pos(p), stage(p.checkers() ? EVASION_INIT : QCAPTURE_INIT) {}
+
+// Generates the moves of type T into list and scores them, returning the end of the list
+template <GenType T>
+ExtMove* MovePicker::generate_scored(ExtMove* list) const {
+    Move generated[MAX_MOVES];
+    const Move* last = generate<T>(pos, generated);
+
+    for (const Move* m = generated; m != last; ++m) {
+        int value;
+        if constexpr (T == TACTICALS) {
+            value = mvv_lva(pos, *m);
+        } else if constexpr (T == QUIETS) {
+            value = psq_gain(pos, *m);
+        } else {
+            value = pos.tactical(*m) ? EvasionCaptureBonus + mvv_lva(pos, *m) : psq_gain(pos, *m);
+        }
+        *list++ = {*m, value};
+    }
+
+    return list;
+}
+
+Move MovePicker::next_move() {
+    switch (stage) {
+        case MAIN_TT:
+        case EVASION_TT:
+            ++stage;
+            return ttMove;
+
+        case CAPTURE_INIT:
+            endMoves = generate_scored<TACTICALS>(cur);
+            partial_insertion_sort(cur, endMoves, INT_MIN);
+            ++stage;
+            [[fallthrough]];
+
+        case GOOD_CAPTURE:
+            while (cur < endMoves) {
+                const ExtMove& em = *cur++;
+                if (em.move == ttMove) {
+                    continue;
+                }
+                if (pos.see_ge(em.move)) {
+                    return em.move;
+                }
+                *endBadCaptures++ = em;
+            }
+            ++stage;
+            [[fallthrough]];
+
+        // A killer is only valid here if it is still a quiet move
+        case KILLER:
+            while (killerIndex < int(killers.size())) {
+                const Move m = killers[killerIndex++];
+                if (m && m != ttMove && pos.pseudo_legal(m) && !pos.tactical(m)) {
+                    return m;
+                }
+            }
+            ++stage;
+            [[fallthrough]];
+
+        case QUIET_INIT:
+            cur = endBadCaptures;
+            endMoves = generate_scored<QUIETS>(cur);
+            partial_insertion_sort(cur, endMoves, QuietSortLimit);
+            ++stage;
+            [[fallthrough]];
+
+        case QUIET:
+            while (cur < endMoves) {
+                const Move m = (cur++)->move;
+                if (m != ttMove && m != killers[0] && m != killers[1]) {
+                    return m;
+                }
+            }
+            cur = moves;
+            endMoves = endBadCaptures;
+            ++stage;
+            [[fallthrough]];
+
+        case BAD_CAPTURE:
+            return cur < endMoves ? (cur++)->move : Move::none();
+
+        case EVASION_INIT:
+        case QCAPTURE_INIT:
+            endMoves = stage == EVASION_INIT ? generate_scored<EVASIONS>(cur)
+                                             : generate_scored<TACTICALS>(cur);
+            partial_insertion_sort(cur, endMoves, INT_MIN);
+            ++stage;
+            [[fallthrough]];
+
+        case EVASION:
+        case QCAPTURE:
+            while (cur < endMoves) {
+                const Move m = (cur++)->move;
+                if (m != ttMove) {
+                    return m;
+                }
+            }
+            return Move::none();
+    }
+
+    assert(false);
+    return Move::none();
+}
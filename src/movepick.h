@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include "movegen.h"
+#include "position.h"
+#include "types.h"
+
+// A move with a score for ordering, higher first
+struct ExtMove {
+    Move move;
+    int value;
+};
+
+// Hands out the pseudo-legal moves of a position one at a time, in stages, generating each stage
+// only when the previous ones are exhausted. A cutoff by an early move saves generating the
+// quiet moves altogether.
+//
+//   1. The hash move
+//   2. Captures and queen promotions that do not lose material, most valuable victim first, then
+//      least valuable attacker
+//   3. The killer moves: quiet moves that caused a cutoff at the same ply
+//   4. The other quiet moves, best piece-square gain first
+//   5. The captures that lose material
+//
+// In check, the evasions follow the hash move, captures first. The quiescence search picker
+// only hands out the captures and queen promotions, all of them in MVV-LVA order, or the evasions
+// in check. Every move is handed out once, the caller still checks legality.
+class MovePicker {
+   public:
+    MovePicker(const Position& pos, Move ttMove, const std::array<Move, 2>& killers);
+    explicit MovePicker(const Position& pos);
+    MovePicker(const MovePicker&) = delete;
+    MovePicker& operator=(const MovePicker&) = delete;
+
+    /// Returns the next move, or Move::none() once all moves have been handed out.
+    Move next_move();
+
+   private:
+    template <GenType T>
+    ExtMove* generate_scored(ExtMove* list) const;
+
+    const Position& pos;
+    Move ttMove = Move::none();
+    std::array<Move, 2> killers{};
+    int stage;
+    int killerIndex = 0;
+
+    // The moves of the current stage are in [cur, endMoves). The captures that lose material are
+    // moved to [moves, endBadCaptures) while the good ones are handed out, the quiet moves are
+    // generated behind them.
+    ExtMove* cur = moves;
+    ExtMove* endMoves = moves;
+    ExtMove* endBadCaptures = moves;
+    ExtMove moves[MAX_MOVES];
+};
@@ -0,0 +1,337 @@
+#include "nnue.h"
+#include <fcntl.h>
+#include <immintrin.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace NNUE {
+
+Network::~Network() {
+    unload();
+}
+
+bool Network::load(const std::string& path) {
+    unload();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    constexpr size_t FileSize = sizeof(Header) + sizeof(Weights);
+    struct stat sb{};
+    void* p = MAP_FAILED;
+
+    if (::fstat(fd, &sb) == 0 && size_t(sb.st_size) == FileSize) {
+        p = ::mmap(nullptr, FileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (p == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* header = static_cast<const Header*>(p);
+    if (header->magic != Magic || header->version != Version ||
+        header->architecture != ArchitectureHash) {
+        ::munmap(p, FileSize);
+        return false;
+    }
+
+    mapping = p;
+    mappingSize = FileSize;
+    weights = reinterpret_cast<const Weights*>(static_cast<const char*>(p) + sizeof(Header));
+    return true;
+}
+
+void Network::unload() {
+    if (mapping) {
+        ::munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    weights = nullptr;
+}
+
+bool write_network(const std::string& path, const Weights& weights) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    const Header header{};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(&weights), sizeof(weights));
+    return bool(file);
+}
+
+namespace {
+
+// The accumulator kernels are written once over V, either an int16_t or a GCC vector of them.
+using Vec16 = int16_t __attribute__((vector_size(32)));
+
+// A move adds and removes at most three features per perspective, a refresh adds up to 30
+constexpr int MaxActiveFeatures = 32;
+
+struct FeatureList {
+    int added[MaxActiveFeatures];
+    int removed[MaxActiveFeatures];
+    int numAdded = 0;
+    int numRemoved = 0;
+};
+
+// Pieces are seen from the perspective: its own pieces come first and, from black's side, the
+// board is mirrored vertically, so both sides share the weights.
+inline int feature(Color perspective, Square ksq, Piece pc, Square s) {
+    const int piece = 2 * (type_of(pc) - PAWN) + (color_of(pc) != perspective);
+    return relative_square(perspective, ksq) * PieceSquares + piece * SQUARE_NB +
+           relative_square(perspective, s);
+}
+
+template <typename V>
+[[gnu::always_inline]] inline V load(const int16_t* p) {
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V>
+[[gnu::always_inline]] inline void apply_features(const Weights& w,
+                                                  const int16_t* prev,
+                                                  int16_t* out,
+                                                  const FeatureList& features) {
+    constexpr int Lanes = sizeof(V) / sizeof(int16_t);
+
+    for (int i = 0; i < L1; i += Lanes) {
+        V v = load<V>(prev + i);
+        for (int j = 0; j < features.numAdded; ++j) {
+            v += load<V>(&w.ftWeights[features.added[j]][i]);
+        }
+        for (int j = 0; j < features.numRemoved; ++j) {
+            v -= load<V>(&w.ftWeights[features.removed[j]][i]);
+        }
+        std::memcpy(out + i, &v, sizeof(V));
+    }
+}
+
+void apply_scalar(const Weights& w, const int16_t* prev, int16_t* out, const FeatureList& f) {
+    apply_features<int16_t>(w, prev, out, f);
+}
+
+[[gnu::target("avx2")]] void apply_avx2(const Weights& w,
+                                        const int16_t* prev,
+                                        int16_t* out,
+                                        const FeatureList& f) {
+    apply_features<Vec16>(w, prev, out, f);
+}
+
+void apply(Kernel kernel,
+           const Weights& w,
+           const int16_t* prev,
+           int16_t* out,
+           const FeatureList& f) {
+    if (kernel >= AVX2) {
+        apply_avx2(w, prev, out, f);
+    } else {
+        apply_scalar(w, prev, out, f);
+    }
+}
+
+// out = bias + weights * in, with weights stored row by row. Inputs are at most 127, so the
+// pairwise int16 sums of the AVX2 kernel never saturate and both kernels agree exactly.
+void affine_scalar(const uint8_t* in,
+                   int inDims,
+                   const int8_t* w,
+                   const int32_t* bias,
+                   int32_t* out,
+                   int outDims) {
+    for (int o = 0; o < outDims; ++o) {
+        int32_t sum = bias[o];
+        for (int i = 0; i < inDims; ++i) {
+            sum += in[i] * w[o * inDims + i];
+        }
+        out[o] = sum;
+    }
+}
+
+[[gnu::target("avx2")]] void affine_avx2(const uint8_t* in,
+                                         int inDims,
+                                         const int8_t* w,
+                                         const int32_t* bias,
+                                         int32_t* out,
+                                         int outDims) {
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (int o = 0; o < outDims; ++o) {
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inDims; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i b =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + o * inDims + i));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, b), ones));
+        }
+
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        out[o] = bias[o] + _mm_cvtsi128_si32(s);
+    }
+}
+
+void affine(Kernel kernel,
+            const uint8_t* in,
+            int inDims,
+            const int8_t* w,
+            const int32_t* bias,
+            int32_t* out,
+            int outDims) {
+    if (kernel >= AVX2) {
+        affine_avx2(in, inDims, w, bias, out, outDims);
+    } else {
+        affine_scalar(in, inDims, w, bias, out, outDims);
+    }
+}
+
+// Clipped ReLU of a hidden layer
+template <int Dims>
+void activate(const int32_t* in, uint8_t* out) {
+    for (int i = 0; i < Dims; ++i) {
+        out[i] = uint8_t(std::clamp(in[i] >> WeightShift, 0, 127));
+    }
+}
+
+Value propagate(const Weights& w, const int16_t* us, const int16_t* them, Kernel kernel) {
+    alignas(64) uint8_t input[2 * L1];
+    alignas(64) int32_t hidden1[L2];
+    alignas(64) uint8_t act1[L2];
+    alignas(64) int32_t hidden2[L3];
+    alignas(64) uint8_t act2[L3];
+    int32_t output;
+
+    // The side to move's accumulator comes first
+    for (int i = 0; i < L1; ++i) {
+        input[i] = uint8_t(std::clamp<int>(us[i], 0, 127));
+        input[L1 + i] = uint8_t(std::clamp<int>(them[i], 0, 127));
+    }
+
+    affine(kernel, input, 2 * L1, &w.l1Weights[0][0], w.l1Biases, hidden1, L2);
+    activate<L2>(hidden1, act1);
+    affine(kernel, act1, L2, &w.l2Weights[0][0], w.l2Biases, hidden2, L3);
+    activate<L3>(hidden2, act2);
+    affine(kernel, act2, L3, w.outWeights, &w.outBias, &output, 1);
+
+    return std::clamp(output / OutputScale, VALUE_MATED_IN_MAX_PLY + 1, VALUE_MATE_IN_MAX_PLY - 1);
+}
+
+void compute_accumulator(const Weights& w,
+                         const Position& pos,
+                         Color perspective,
+                         int16_t* out,
+                         Kernel kernel) {
+    const Square ksq = pos.square<KING>(perspective);
+    FeatureList features;
+
+    for (Bitboard b = pos.pieces() ^ pos.pieces<KING>(); b;) {
+        Square s = pop_lsb(b);
+        features.added[features.numAdded++] = feature(perspective, ksq, pos.piece_on(s), s);
+    }
+
+    apply(kernel, w, w.ftBiases, out, features);
+}
+
+}  // namespace
+
+AccumulatorStack::AccumulatorStack(Kernel k) : kernel(k), stack(MAX_PLY + 1) {
+    reset();
+}
+
+void AccumulatorStack::reset() {
+    size = 1;
+    stack[0].computed[WHITE] = stack[0].computed[BLACK] = false;
+    stack[0].dirtyPiece.count = 0;
+}
+
+void AccumulatorStack::push(const DirtyPiece& dp) {
+    assert(size < stack.size());
+
+    Accumulator& acc = stack[size++];
+    acc.computed[WHITE] = acc.computed[BLACK] = false;
+    acc.dirtyPiece = dp;
+}
+
+void AccumulatorStack::pop() {
+    assert(size > 1);
+    --size;
+}
+
+Value AccumulatorStack::evaluate(const Network& network, const Position& pos) {
+    Accumulator& acc = stack[size - 1];
+
+    for (Color c : {WHITE, BLACK}) {
+        if (!acc.computed[c]) {
+            update(network, pos, c);
+        }
+    }
+
+    const Color us = pos.side_to_move();
+    return propagate(network.params(), acc.values[us], acc.values[~us], kernel);
+}
+
+// Finds the closest computed accumulator below the top and replays the moves since, computing
+// every accumulator on the way so that sibling nodes start from them. A move of the perspective's
+// king changes all of its features, then only a refresh helps.
+void AccumulatorStack::update(const Network& network, const Position& pos, Color perspective) {
+    const Piece king = make_piece(perspective, KING);
+    size_t i = size - 1;
+
+    for (; !stack[i].computed[perspective]; --i) {
+        if (i == 0 || stack[i].dirtyPiece.piece[0] == king) {
+            refresh(network, pos, perspective);
+            return;
+        }
+    }
+
+    const Square ksq = pos.square<KING>(perspective);
+
+    for (++i; i < size; ++i) {
+        const DirtyPiece& dp = stack[i].dirtyPiece;
+        FeatureList features;
+
+        for (int j = 0; j < dp.count; ++j) {
+            if (type_of(dp.piece[j]) == KING) {
+                continue;
+            }
+            if (dp.from[j] != SQ_NONE) {
+                features.removed[features.numRemoved++] =
+                    feature(perspective, ksq, dp.piece[j], dp.from[j]);
+            }
+            if (dp.to[j] != SQ_NONE) {
+                features.added[features.numAdded++] =
+                    feature(perspective, ksq, dp.piece[j], dp.to[j]);
+            }
+        }
+
+        apply(kernel, network.params(), stack[i - 1].values[perspective],
+              stack[i].values[perspective], features);
+        stack[i].computed[perspective] = true;
+    }
+}
+
+void AccumulatorStack::refresh(const Network& network, const Position& pos, Color perspective) {
+    Accumulator& acc = stack[size - 1];
+    compute_accumulator(network.params(), pos, perspective, acc.values[perspective], kernel);
+    acc.computed[perspective] = true;
+}
+
+Value evaluate(const Network& network, const Position& pos, Kernel kernel) {
+    alignas(64) int16_t values[COLOR_NB][L1];
+    const Color us = pos.side_to_move();
+
+    compute_accumulator(network.params(), pos, us, values[us], kernel);
+    compute_accumulator(network.params(), pos, ~us, values[~us], kernel);
+    return propagate(network.params(), values[us], values[~us], kernel);
+}
+
+}  // namespace NNUE
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "types.h"
+#include "utils.h"
+
+// An efficiently updatable neural network evaluator. The input layer has one feature per
+// (king square, piece, square) triple, seen from each side in turn (HalfKP): its output, the
+// accumulator, only changes by a few weight columns per move and is updated incrementally.
+// Three small integer layers then turn the two accumulators into an evaluation.
+namespace NNUE {
+
+// Every piece except the kings, by colour relative to the perspective, on every square
+constexpr int PieceSquares = 10 * SQUARE_NB;
+constexpr int Inputs = SQUARE_NB * PieceSquares;
+constexpr int L1 = 256;
+constexpr int L2 = 32;
+constexpr int L3 = 32;
+
+// Hidden layer outputs are shifted down by this many bits before clipping to [0, 127], and
+// the output is divided by OutputScale to get centipawns.
+constexpr int WeightShift = 6;
+constexpr int OutputScale = 16;
+
+constexpr uint32_t Magic = 0x45554E4E;  // "NNUE"
+constexpr uint32_t Version = 1;
+constexpr uint32_t ArchitectureHash = uint32_t(Inputs) ^ (L1 << 20) ^ (L2 << 10) ^ L3;
+
+struct Header {
+    uint32_t magic = Magic;
+    uint32_t version = Version;
+    uint32_t architecture = ArchitectureHash;
+    uint8_t padding[52]{};
+};
+
+static_assert(sizeof(Header) == 64, "Header size incorrect");
+
+// The parameters as laid out in a network file, right after the Header. Every array starts on a
+// cache line, so the mapped file can be used in place.
+struct Weights {
+    alignas(64) int16_t ftBiases[L1];
+    alignas(64) int16_t ftWeights[Inputs][L1];
+    alignas(64) int32_t l1Biases[L2];
+    alignas(64) int8_t l1Weights[L2][2 * L1];
+    alignas(64) int32_t l2Biases[L3];
+    alignas(64) int8_t l2Weights[L3][L2];
+    alignas(64) int32_t outBias;
+    alignas(64) int8_t outWeights[L3];
+};
+
+// A network file mapped into memory read-only, shared by all threads
+class Network {
+   public:
+    Network() = default;
+    ~Network();
+    Network(const Network&) = delete;
+    Network& operator=(const Network&) = delete;
+
+    /// Maps the network file at path, replacing any loaded network. Returns false and leaves no
+    /// network loaded if the file cannot be mapped or is not a network of this architecture.
+    bool load(const std::string& path);
+    void unload();
+
+    bool loaded() const { return weights != nullptr; }
+    const Weights& params() const { return *weights; }
+
+   private:
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    const Weights* weights = nullptr;
+};
+
+/// Writes a network file in the format load() expects. Returns false on I/O errors.
+bool write_network(const std::string& path, const Weights& weights);
+
+struct alignas(64) Accumulator {
+    int16_t values[COLOR_NB][L1];
+    bool computed[COLOR_NB];
+    // The change from the previous accumulator on the stack
+    DirtyPiece dirtyPiece;
+};
+
+// The accumulators of the positions along the current line, one per ply. push() after making a
+// move only records what changed; the accumulators are brought up to date when evaluating, from
+// the closest computed one below, or from scratch when a king has moved since.
+class AccumulatorStack {
+   public:
+    explicit AccumulatorStack(Kernel kernel = best_kernel());
+
+    /// Starts a new line at pos, every accumulator is computed on demand
+    void reset();
+    void push(const DirtyPiece& dp);
+    void pop();
+
+    /// Evaluates pos, which must be the position of the top of the stack, from the side to
+    /// move's point of view.
+    Value evaluate(const Network& network, const Position& pos);
+
+   private:
+    void update(const Network& network, const Position& pos, Color perspective);
+    void refresh(const Network& network, const Position& pos, Color perspective);
+
+    Kernel kernel;
+    std::vector<Accumulator> stack;
+    size_t size = 0;
+};
+
+/// Evaluates pos from scratch, without any incremental update
+Value evaluate(const Network& network, const Position& pos, Kernel kernel = best_kernel());
+
+}  // namespace NNUE
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include "bitboard.h"
+#include "pawns.h"
+
+namespace Pawns {
+
+namespace {
+
+constexpr Score S(int mg, int eg) {
+    return make_score(mg, eg);
+}
+
+constexpr Score Isolated = S(5, 15);
+constexpr Score Doubled = S(10, 40);
+constexpr Score Backward = S(8, 20);
+
+// By relative rank
+constexpr Score Passed[RANK_NB] = {
+    SCORE_ZERO, S(0, 10), S(5, 15), S(10, 25), S(25, 50), S(50, 100), S(90, 160), SCORE_ZERO};
+
+// By relative rank of the rearmost pawn in front of the king on a file, RANK_1 if there is none
+constexpr int ShelterStrength[RANK_NB] = {-25, 0, 25, 15, 5, 0, 0, 0};
+
+template <Color Us>
+Score evaluate_side(const Position& pos, Entry& e) {
+    constexpr Color Them = ~Us;
+    constexpr Direction Up = pawn_push(Us);
+
+    const Bitboard ourPawns = pos.pieces<PAWN>(Us);
+    const Bitboard theirPawns = pos.pieces<PAWN>(Them);
+    Score score = SCORE_ZERO;
+
+    e.passedPawns[Us] = 0;
+    e.pawnAttacks[Us] = pawn_attacks_bb<Us>(ourPawns);
+    e.pawnAttacksSpan[Us] = 0;
+
+    for (Bitboard b = ourPawns; b;) {
+        const Square s = pop_lsb(b);
+        const Bitboard neighbours = ourPawns & adjacent_files_bb(s);
+
+        e.pawnAttacksSpan[Us] |= pawn_attack_span(Us, s);
+
+        if (!(theirPawns & passed_pawn_span(Us, s))) {
+            e.passedPawns[Us] |= s;
+            score += Passed[relative_rank(Us, s)];
+        }
+
+        // Only the rear pawn of a doubled pair is penalized
+        if (ourPawns & forward_file_bb(Us, s)) {
+            score -= Doubled;
+        }
+
+        // A backward pawn has no neighbour beside or behind it to support its advance, and its
+        // stop square is attacked by an enemy pawn
+        if (!neighbours) {
+            score -= Isolated;
+        } else if (!(neighbours & ~forward_ranks_bb(Us, s)) &&
+                   (pawn_attacks_bb<Us>(square_bb(s + Up)) & theirPawns)) {
+            score -= Backward;
+        }
+    }
+
+    return score;
+}
+
+// The pawns on the king's rank or in front of it, on its file and the adjacent ones. A king on
+// the edge is sheltered by the same files as one next to it.
+Score shelter(const Position& pos, Color c, Square ksq) {
+    const Bitboard pawns = pos.pieces<PAWN>(c) & ~forward_ranks_bb(~c, ksq);
+    const File center = std::clamp(file_of(ksq), FILE_B, FILE_G);
+    int bonus = 0;
+
+    for (File f = File(center - 1); f <= File(center + 1); ++f) {
+        const Bitboard b = pawns & file_bb(f);
+        bonus += ShelterStrength[b ? relative_rank(c, c == WHITE ? lsb(b) : msb(b)) : RANK_1];
+    }
+
+    return S(bonus, 0);
+}
+
+}  // namespace
+
+Score Entry::king_shelter(const Position& pos, Color c) {
+    const Square ksq = pos.square<KING>(c);
+    if (kingSquares[c] != ksq) {
+        kingSquares[c] = ksq;
+        kingShelter[c] = shelter(pos, c, ksq);
+    }
+    return kingShelter[c];
+}
+
+void evaluate(const Position& pos, Entry& e) {
+    e.key = pos.pawn_key();
+    e.scores[WHITE] = evaluate_side<WHITE>(pos, e);
+    e.scores[BLACK] = evaluate_side<BLACK>(pos, e);
+    e.kingSquares[WHITE] = e.kingSquares[BLACK] = SQ_NONE;
+}
+
+Entry* Table::probe(const Position& pos) {
+    Entry* e = &entries[pos.pawn_key() & (Size - 1)];
+
+    ++probeCount;
+    if (e->key == pos.pawn_key()) {
+        ++hitCount;
+        return e;
+    }
+
+    evaluate(pos, *e);
+    return e;
+}
+
+void Table::clear() {
+    Entry empty{};
+    empty.kingSquares[WHITE] = empty.kingSquares[BLACK] = SQ_NONE;
+    std::fill_n(entries.get(), Size, empty);
+}
+
+}  // namespace Pawns
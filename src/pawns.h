@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "position.h"
+#include "types.h"
+
+namespace Pawns {
+
+// The pawn structure of a position: the score of each side's pawns and the bitboards derived from
+// them. All of it depends on the pawns only, except the king shelter, which also depends on the
+// king square and is cached for the last one asked for.
+struct Entry {
+    Score pawn_score(Color c) const { return scores[c]; }
+    Bitboard passed_pawns(Color c) const { return passedPawns[c]; }
+    Bitboard pawn_attacks(Color c) const { return pawnAttacks[c]; }
+    // The squares the pawns of color c could attack while advancing
+    Bitboard pawn_attacks_span(Color c) const { return pawnAttacksSpan[c]; }
+
+    // The middlegame score of the pawns in front of the king of color c
+    Score king_shelter(const Position& pos, Color c);
+
+    Key key;
+    Score scores[COLOR_NB];
+    Bitboard passedPawns[COLOR_NB];
+    Bitboard pawnAttacks[COLOR_NB];
+    Bitboard pawnAttacksSpan[COLOR_NB];
+    Square kingSquares[COLOR_NB];
+    Score kingShelter[COLOR_NB];
+};
+
+/// Evaluates the pawn structure of pos into e, without a table.
+void evaluate(const Position& pos, Entry& e);
+
+// A pawn hash table keyed by the pawn key of the position. The pawn structure rarely changes
+// between nodes, so most probes hit. It is not thread safe, every search thread owns one.
+class Table {
+   public:
+    static constexpr size_t Size = 1 << 14;
+
+    Table() : entries(std::make_unique<Entry[]>(Size)) { clear(); }
+
+    /// Returns the entry of the pawn structure of pos, evaluating it on a miss. The previous
+    /// entry at its index is replaced.
+    Entry* probe(const Position& pos);
+    void clear();
+
+    uint64_t probes() const { return probeCount; }
+    uint64_t hits() const { return hitCount; }
+    void reset_counters() { probeCount = hitCount = 0; }
+
+   private:
+    std::unique_ptr<Entry[]> entries;
+    uint64_t probeCount = 0;
+    uint64_t hitCount = 0;
+};
+
+}  // namespace Pawns
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "movegen.h"
+#include "perft.h"
+
+namespace Perft {
+
+namespace {
+
+constexpr int DepthBits = 8;
+
+constexpr uint64_t pack(int depth, uint64_t nodes) {
+    return (nodes << DepthBits) | uint64_t(depth);
+}
+
+constexpr int depth_of(uint64_t data) {
+    return int(data & ((1 << DepthBits) - 1));
+}
+
+constexpr uint64_t nodes_of(uint64_t data) {
+    return data >> DepthBits;
+}
+
+// Subtrees of depth 1 are counted faster than they are probed.
+constexpr int MinHashDepth = 2;
+
+template <bool Hashed>
+uint64_t perft(Position& pos, int depth, HashTable* tt, Result& result) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    // Bulk counting: the leaves are the legal moves, there is no need to make them.
+    if (depth == 1) {
+        return MoveList<LEGAL>(pos).size();
+    }
+
+    if constexpr (Hashed) {
+        if (depth >= MinHashDepth) {
+            uint64_t nodes;
+            ++result.probes;
+            if (tt->probe(pos.key(), depth, nodes)) {
+                ++result.hits;
+                return nodes;
+            }
+        }
+    }
+
+    StateInfo st;
+    uint64_t nodes = 0;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        pos.make_move(m, st);
+        nodes += perft<Hashed>(pos, depth - 1, tt, result);
+        pos.unmake_move(m);
+    }
+
+    if constexpr (Hashed) {
+        if (depth >= MinHashDepth) {
+            tt->store(pos.key(), depth, nodes);
+        }
+    }
+
+    return nodes;
+}
+
+uint64_t perft_copy_make(const Position& pos, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+
+    if (depth == 1) {
+        return MoveList<LEGAL>(pos).size();
+    }
+
+    uint64_t nodes = 0;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        Position child = pos;
+        child.make_move(m);
+        nodes += perft_copy_make(child, depth - 1);
+    }
+
+    return nodes;
+}
+
+// A split point: the subtree reached by playing path from the root, searched to depth.
+struct Task {
+    std::vector<Move> path;
+    int depth;
+};
+
+// Split until every thread has this many tasks to choose from, so threads finishing early can
+// steal work from those with big subtrees.
+constexpr size_t TasksPerThread = 8;
+
+// Subtrees shallower than this are counted faster than they are split.
+constexpr int MinSplitDepth = 3;
+
+// Plays the moves of path on pos, using states to store the state of each move.
+void replay(Position& pos, const std::vector<Move>& path, std::vector<StateInfo>& states) {
+    states.resize(std::max(states.size(), path.size()));
+    for (size_t i = 0; i < path.size(); ++i) {
+        pos.make_move(path[i], states[i]);
+    }
+}
+
+void retract(Position& pos, const std::vector<Move>& path) {
+    for (auto m = path.rbegin(); m != path.rend(); ++m) {
+        pos.unmake_move(*m);
+    }
+}
+
+// Expands the tree one ply at a time from the root until there are at least minTasks subtrees,
+// or until they become too shallow to be worth splitting.
+std::vector<Task> split(Position& pos, int depth, size_t minTasks) {
+    std::vector<Task> tasks{{{}, depth}};
+    std::vector<StateInfo> states;
+
+    while (tasks.size() < minTasks && depth > MinSplitDepth) {
+        std::vector<Task> next;
+        --depth;
+
+        for (const Task& task : tasks) {
+            replay(pos, task.path, states);
+            for (const auto& m : MoveList<LEGAL>(pos)) {
+                next.push_back({task.path, depth});
+                next.back().path.push_back(m);
+            }
+            retract(pos, task.path);
+        }
+
+        tasks = std::move(next);
+    }
+
+    return tasks;
+}
+
+// A queue of task indices owned by one worker. The owner pops from the back, thieves take from
+// the front, so they tend to get the tasks the owner would have reached last.
+class WorkQueue {
+   public:
+    void push(size_t task) {
+        std::lock_guard lock(mutex);
+        tasks.push_back(task);
+    }
+
+    bool pop(size_t& task) {
+        std::lock_guard lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t& task) {
+        std::lock_guard lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+   private:
+    std::mutex mutex{};
+    std::deque<size_t> tasks{};
+};
+
+}  // namespace
+
+void HashTable::resize(size_t mbSize) {
+    size_t clusters = (mbSize << 20) / sizeof(Cluster);
+    clusterCount = std::bit_floor(std::max<size_t>(clusters, 1));
+    table = std::make_unique<Cluster[]>(clusterCount);
+    clear();
+}
+
+void HashTable::clear() {
+    std::memset(static_cast<void*>(table.get()), 0, clusterCount * sizeof(Cluster));
+}
+
+bool HashTable::probe(Key key, int depth, uint64_t& nodes) const {
+    for (const Entry& e : first_entry(key)->entry) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = e.keyXorData.load(std::memory_order_relaxed);
+
+        if ((keyXorData ^ data) == key && depth_of(data) == depth) {
+            nodes = nodes_of(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stores the entry over the shallowest one in the cluster, preferring an entry of the same key.
+// Deep entries save the most work on a hit, so they are the last to be replaced.
+void HashTable::store(Key key, int depth, uint64_t nodes) {
+    Entry* replace = nullptr;
+    int replaceDepth = 256;
+
+    for (Entry& e : first_entry(key)->entry) {
+        uint64_t data = e.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = e.keyXorData.load(std::memory_order_relaxed);
+
+        if ((keyXorData ^ data) == key) {
+            replace = &e;
+            break;
+        }
+
+        if (depth_of(data) < replaceDepth) {
+            replace = &e;
+            replaceDepth = depth_of(data);
+        }
+    }
+
+    uint64_t data = pack(depth, nodes);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+double Result::nps() const {
+    auto ns = std::max<int64_t>(elapsed.count(), 1);
+    return double(nodes) * 1e9 / double(ns);
+}
+
+double Result::hit_rate() const {
+    return probes ? double(hits) / double(probes) : 0.0;
+}
+
+Result& Result::operator+=(const Result& rhs) {
+    nodes += rhs.nodes;
+    probes += rhs.probes;
+    hits += rhs.hits;
+    elapsed = std::max(elapsed, rhs.elapsed);
+    return *this;
+}
+
+Result run(Position& pos, int depth, HashTable* tt) {
+    Result result{};
+    auto start = std::chrono::steady_clock::now();
+
+    result.nodes = tt ? perft<true>(pos, depth, tt, result) : perft<false>(pos, depth, tt, result);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+
+    return result;
+}
+
+Result run_copy_make(const Position& pos, int depth) {
+    Result result{};
+    auto start = std::chrono::steady_clock::now();
+
+    result.nodes = perft_copy_make(pos, depth);
+    result.elapsed = std::chrono::steady_clock::now() - start;
+
+    return result;
+}
+
+Result run_parallel(const Position& pos, int depth, size_t threads, HashTable* tt) {
+    threads = std::max<size_t>(threads, 1);
+    auto start = std::chrono::steady_clock::now();
+
+    Position root = pos;
+    const std::vector<Task> tasks = split(root, depth, threads * TasksPerThread);
+
+    std::vector<WorkQueue> queues(threads);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % threads].push(i);
+    }
+
+    std::vector<Result> results(threads);
+    std::vector<std::thread> workers;
+
+    for (size_t id = 0; id < threads; ++id) {
+        workers.emplace_back([&, id]() {
+            Position local = root;
+            std::vector<StateInfo> states;
+            Result& result = results[id];
+            size_t task;
+
+            auto next_task = [&]() {
+                if (queues[id].pop(task)) {
+                    return true;
+                }
+                for (size_t i = 1; i < threads; ++i) {
+                    if (queues[(id + i) % threads].steal(task)) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            while (next_task()) {
+                const Task& t = tasks[task];
+                replay(local, t.path, states);
+                result.nodes += tt ? perft<true>(local, t.depth, tt, result)
+                                   : perft<false>(local, t.depth, tt, result);
+                retract(local, t.path);
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Result total{};
+    for (const Result& result : results) {
+        total += result;
+    }
+    total.elapsed = std::chrono::steady_clock::now() - start;
+
+    return total;
+}
+
+}  // namespace Perft
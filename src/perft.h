@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "position.h"
+#include "types.h"
+
+namespace Perft {
+
+// A perft hash entry stores the node count of a (key, depth) pair. The key is stored xored with
+// the data word, so an entry torn by a concurrent write is detected on probe and treated as a
+// miss. This makes the table safe to share between threads without any locking.
+//
+// data bit  0- 7: depth
+// data bit  8-63: node count
+struct Entry {
+    std::atomic<uint64_t> keyXorData{};
+    std::atomic<uint64_t> data{};
+};
+
+constexpr int ClusterSize = 4;
+
+// Entries are grouped in clusters of one cache line, a probe touches a single line.
+struct alignas(64) Cluster {
+    Entry entry[ClusterSize];
+};
+
+static_assert(sizeof(Cluster) == 64, "Cluster size incorrect");
+
+class HashTable {
+   public:
+    explicit HashTable(size_t mbSize = 16) { resize(mbSize); }
+
+    /// Resizes the table to the largest power of two number of clusters fitting in mbSize
+    /// megabytes. All entries are cleared.
+    void resize(size_t mbSize);
+    void clear();
+
+    /// Returns true and sets nodes if an entry for the given key and depth is found.
+    bool probe(Key key, int depth, uint64_t& nodes) const;
+    void store(Key key, int depth, uint64_t nodes);
+
+    size_t size_mb() const { return clusterCount * sizeof(Cluster) >> 20; }
+
+   private:
+    Cluster* first_entry(Key key) const { return &table[key & (clusterCount - 1)]; }
+
+    std::unique_ptr<Cluster[]> table{};
+    size_t clusterCount = 0;
+};
+
+struct Result {
+    uint64_t nodes = 0;
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    std::chrono::nanoseconds elapsed{};
+
+    double nps() const;
+    double hit_rate() const;
+
+    Result& operator+=(const Result& rhs);
+};
+
+/// Counts the leaf nodes of the legal move tree of the given depth. If a hash table is given,
+/// subtrees are looked up and stored in it, so transpositions are only expanded once.
+Result run(Position& pos, int depth, HashTable* tt = nullptr);
+
+/// Same as run() without a hash table, but every child is made on a copy of its parent instead of
+/// making and unmaking moves on a single position.
+Result run_copy_make(const Position& pos, int depth);
+
+/// Same as run(), but splits the tree below the root (and deeper when there are few moves) into
+/// subtrees counted by a work-stealing pool of the given number of threads. Every thread works on
+/// its own copy of the position. The hash table, if any, is shared between all threads.
+Result run_parallel(const Position& pos, int depth, size_t threads, HashTable* tt = nullptr);
+
+}  // namespace Perft
@@ -1,20 +1,69 @@
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <cstddef>
+#include <cstring>
 #include <ios>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include "bitboard.h"
 #include "macros.h"
+#include "movegen.h"
 #include "position.h"
 #include "pretty.h"
 #include "types.h"
+#include "utils.h"
 
 using namespace Bitboards;
 
+namespace Zobrist {
+
+struct Keys {
+    std::array<std::array<Key, SQUARE_NB>, PIECE_NB> psq;
+    std::array<Key, FILE_NB> enpassant;
+    std::array<Key, CASTLING_RIGHT_NB> castling;
+    Key side;
+    Key noPawns;
+};
+
+// Random keys for every piece on every square, en passant file, castling rights combination and
+// side to move. The material key reuses psq[pc][n] as the key of the n-th piece of a kind.
+constexpr Keys keys = []() constexpr {
+    Keys k{};
+    PRNG rng(1070372);
+
+    for (auto& squares : k.psq) {
+        for (Key& key : squares) {
+            key = rng.rand<Key>();
+        }
+    }
+
+    for (Key& key : k.enpassant) {
+        key = rng.rand<Key>();
+    }
+
+    for (Key& key : k.castling) {
+        key = rng.rand<Key>();
+    }
+
+    k.side = rng.rand<Key>();
+    k.noPawns = rng.rand<Key>();
+
+    return k;
+}();
+
+constexpr const auto& psq = keys.psq;
+constexpr const auto& enpassant = keys.enpassant;
+constexpr const auto& castling = keys.castling;
+constexpr Key side = keys.side;
+constexpr Key noPawns = keys.noPawns;
+
+}  // namespace Zobrist
+
 Position::Position(const std::string fenStr) {
     std::istringstream ss{fenStr};
     Square sq = SQ_A8;
-    st = new StateInfo{};
 
     char token, col, row;
 
@@ -48,21 +97,75 @@ Position::Position(const std::string fenStr) {
             castling |= (c == WHITE ? WHITE_OOO : BLACK_OOO);
         }
     }
-    st->castlingRights = castling;
+    st.castlingRights = castling;
 
     if (((ss >> col) && col >= 'a' && col <= 'h') &&
         ((ss >> row) && row == (sideToMove == WHITE ? '6' : '3'))) {
-        st->epSquare = make_square(File(col - 'a'), Rank(row - '1'));
+        st.epSquare = make_square(File(col - 'a'), Rank(row - '1'));
     } else {
-        st->epSquare = SQ_NONE;
+        st.epSquare = SQ_NONE;
     }
 
-    ss >> std::skipws >> st->rule50 >> gamePly;
+    ss >> std::skipws >> st.rule50 >> gamePly;
 
     gamePly = std::max(2 * (gamePly - 1), 0) + (sideToMove == BLACK);
-    st->checkersBB = attackers_to(square<KING>(sideToMove)) & pieces(~sideToMove);
+    set_state();
+}
+
+Position::Position(const PackedPosition& packed) {
+    unpack(packed);
+}
 
-    update_slider_blockers(sideToMove);
+// Computes the parts of the current state that follow from the board, once the pieces, side to
+// move, castling rights, en passant square and rule50 are set.
+void Position::set_state() {
+    st.checkersBB = attackers_to(square<KING>(sideToMove)) & pieces(~sideToMove);
+    st.key = compute_key();
+    st.pawnKey = compute_pawn_key();
+    st.materialKey = compute_material_key();
+    st.dirtyBlockers = (1 << WHITE) | (1 << BLACK);
+    st.dirtyCheckSquares = true;
+}
+
+PackedPosition Position::pack() const {
+    PackedPosition packed{};
+    int i = 0;
+
+    assert(popcount(pieces()) <= 32);
+
+    packed.occupied = pieces();
+    for (Bitboard b = pieces(); b; ++i) {
+        packed.pieces[i / 2] |= piece_on(pop_lsb(b)) << (4 * (i % 2));
+    }
+
+    packed.rule50 = uint16_t(st.rule50);
+    packed.gamePly = uint16_t(gamePly);
+    packed.sideToMove = uint8_t(sideToMove);
+    packed.castlingRights = uint8_t(st.castlingRights);
+    packed.epSquare = uint8_t(st.epSquare);
+
+    return packed;
+}
+
+void Position::unpack(const PackedPosition& packed) {
+    board_.fill(NO_PIECE);
+    byColorBB = {};
+    byTypeBB = {};
+    pieceCount = {};
+    st = {};
+    psq = SCORE_ZERO;
+
+    int i = 0;
+    for (Bitboard b = packed.occupied; b; ++i) {
+        put_piece(Piece((packed.pieces[i / 2] >> (4 * (i % 2))) & 0xF), pop_lsb(b));
+    }
+
+    sideToMove = Color(packed.sideToMove);
+    gamePly = packed.gamePly;
+    st.rule50 = packed.rule50;
+    st.castlingRights = CastlingRights(packed.castlingRights);
+    st.epSquare = Square(packed.epSquare);
+    set_state();
 }
 
 std::string Position::as_fen() const {
@@ -105,7 +208,7 @@ std::string Position::as_fen() const {
     if (!can_castle(ANY_CASTLING))
         ss << '-';
 
-    ss << (st->epSquare == SQ_NONE ? " - " : " " + pretty(st->epSquare) + " ") << st->rule50 << " "
+    ss << (st.epSquare == SQ_NONE ? " - " : " " + pretty(st.epSquare) + " ") << st.rule50 << " "
        << 1 + (gamePly - (sideToMove == BLACK)) / 2;
 
     return ss.str();
@@ -121,6 +224,9 @@ void Position::put_piece(Piece p, Square s) {
     board_[s] = p;
     byTypeBB[ALL_PIECES] |= byTypeBB[type_of(p)] |= s;
     byColorBB[color_of(p)] |= s;
+    ++pieceCount[p];
+    ++pieceCount[make_piece(color_of(p), ALL_PIECES)];
+    psq += PSQT::psq[p][s];
 }
 
 void Position::remove_piece(Square s) {
@@ -131,6 +237,9 @@ void Position::remove_piece(Square s) {
     byTypeBB[type_of(p)] ^= s;
     byColorBB[color_of(p)] ^= s;
     board_[s] = NO_PIECE;
+    --pieceCount[p];
+    --pieceCount[make_piece(color_of(p), ALL_PIECES)];
+    psq -= PSQT::psq[p][s];
 }
 
 // Moves a piece from the from square, to the to square. Assumes the `to` square is empty.
@@ -145,10 +254,65 @@ void Position::move_piece(Square from, Square to) {
     byColorBB[color_of(p)] ^= fromTo;
     board_[from] = NO_PIECE;
     board_[to] = p;
+    psq += PSQT::psq[p][to] - PSQT::psq[p][from];
+}
+
+Key Position::compute_key() const {
+    Key k = Zobrist::castling[st.castlingRights];
+
+    for (Bitboard b = pieces(); b;) {
+        Square s = pop_lsb(b);
+        k ^= Zobrist::psq[piece_on(s)][s];
+    }
+
+    if (st.epSquare != SQ_NONE) {
+        k ^= Zobrist::enpassant[file_of(st.epSquare)];
+    }
+
+    if (sideToMove == BLACK) {
+        k ^= Zobrist::side;
+    }
+
+    return k;
+}
+
+Key Position::compute_pawn_key() const {
+    Key k = Zobrist::noPawns;
+
+    for (Bitboard b = pieces<PAWN>(); b;) {
+        Square s = pop_lsb(b);
+        k ^= Zobrist::psq[piece_on(s)][s];
+    }
+
+    return k;
+}
+
+Key Position::compute_material_key() const {
+    Key k{};
+
+    for (Piece pc : {W_PAWN, W_KNIGHT, W_BISHOP, W_ROOK, W_QUEEN, W_KING, B_PAWN, B_KNIGHT,
+                     B_BISHOP, B_ROOK, B_QUEEN, B_KING}) {
+        for (int cnt = 0; cnt < count(pc); ++cnt) {
+            k ^= Zobrist::psq[pc][cnt];
+        }
+    }
+
+    return k;
+}
+
+Score Position::compute_psq_score() const {
+    Score score = SCORE_ZERO;
+
+    for (Bitboard b = pieces(); b;) {
+        Square s = pop_lsb(b);
+        score += PSQT::psq[piece_on(s)][s];
+    }
+
+    return score;
 }
 
 bool Position::can_castle(CastlingRights cr) const {
-    return st->castlingRights & cr;
+    return st.castlingRights & cr;
 }
 
 bool Position::castling_impeded(CastlingRights cr) const {
@@ -210,11 +374,81 @@ bool Position::legal(Move m) const {
     return !(blockers_for_king(us) & from) || line_bb(from, to) & square<KING>(us);
 }
 
-bool Position::pseudo_legal(Move m) const {}
+// Takes a random move and tests whether it is pseudo-legal, i.e. whether generate<EVASIONS> (when
+// in check) or generate<NON_EVASIONS> (otherwise) would emit it. It is used to validate moves from
+// untrusted sources, such as a hash table or a killer slot, without generating any moves.
+bool Position::pseudo_legal(Move m) const {
+    if (!m.is_ok()) {
+        return false;
+    }
+
+    Color us = sideToMove;
+    Square from = m.from_sq();
+    Square to = m.to_sq();
+    Piece pc = moved_piece(m);
+
+    // The moved piece must be ours
+    if (pc == NO_PIECE || color_of(pc) != us) {
+        return false;
+    }
+
+    // Only promotions use the promotion piece bits
+    if (m.type_of() != PROMOTION && m.promotion_type() != KNIGHT) {
+        return false;
+    }
+
+    if (m.type_of() == CASTLING) {
+        CastlingRights cr = us & (to > from ? KING_SIDE : QUEEN_SIDE);
+
+        return type_of(pc) == KING && !checkers() && can_castle(cr) && !castling_impeded(cr) &&
+               to == castling_rook_square(cr);
+    }
+
+    if (type_of(pc) == KING) {
+        return m.type_of() == NORMAL && (attacks_bb<KING>(from) & to) && !(pieces(us) & to);
+    }
+
+    // In double check only the king can move. In single check, the other pieces must block the
+    // check or capture the checker.
+    Bitboard target = ~pieces(us);
+    if (checkers()) {
+        if (more_than_one(checkers())) {
+            return false;
+        }
+        target = between_bb(square<KING>(us), lsb(checkers()));
+    }
+
+    if (type_of(pc) != PAWN) {
+        return m.type_of() == NORMAL && (attacks_bb(type_of(pc), from, pieces()) & target & to);
+    }
+
+    Direction up = pawn_push(us);
+
+    if (m.type_of() == EN_PASSANT) {
+        // An en passant capture cannot resolve a discovered check
+        return to == ep_square() && (attacks_bb<PAWN>(from, us) & to) &&
+               !(checkers() && (target & (to + up)));
+    }
+
+    // Pawn moves to the last rank must be promotions, and promotions must reach it
+    if ((m.type_of() == PROMOTION) != (relative_rank(us, to) == RANK_8)) {
+        return false;
+    }
 
-void Position::update_slider_blockers(Color c) {
-    st->blockersForKing[c] = 0;
-    st->pinners[~c] = 0;
+    Bitboard enemies = checkers() ? checkers() : pieces(~us);
+
+    return (attacks_bb<PAWN>(from, us) & enemies & to) ||                 // Capture
+           (to == from + up && is_empty(to) && (target & to)) ||          // Single push
+           (to == from + 2 * up && relative_rank(us, from) == RANK_2 &&  // Double push
+            is_empty(to - up) && is_empty(to) && (target & to));
+}
+
+// Computes the pieces blocking a slider attack on the king of color c, and the sliders of ~c
+// pinning a piece of color c.
+void Position::update_slider_blockers(Color c) const {
+    st.dirtyBlockers &= ~(1 << c);
+    st.blockersForKing[c] = 0;
+    st.pinners[~c] = 0;
 
     Square ksq = square<KING>(c);
 
@@ -227,59 +461,349 @@ void Position::update_slider_blockers(Color c) {
         Bitboard b = between_bb(ksq, sniperSq) & occupancy;
 
         if (b && !more_than_one(b)) {
-            st->blockersForKing[c] |= b;
+            st.blockersForKing[c] |= b;
             if (b & pieces(c)) {
-                st->pinners[~c] |= sniperSq;
+                st.pinners[~c] |= sniperSq;
             }
         }
     }
 }
 
+void Position::update_check_squares() const {
+    Square ksq = square<KING>(~sideToMove);
+
+    st.dirtyCheckSquares = false;
+    st.checkSquares[PAWN] = attacks_bb<PAWN>(ksq, ~sideToMove);
+    st.checkSquares[KNIGHT] = attacks_bb<KNIGHT>(ksq);
+    st.checkSquares[BISHOP] = attacks_bb<BISHOP>(ksq, pieces());
+    st.checkSquares[ROOK] = attacks_bb<ROOK>(ksq, pieces());
+    st.checkSquares[QUEEN] = st.checkSquares[BISHOP] | st.checkSquares[ROOK];
+    st.checkSquares[KING] = 0;
+}
+
+// Tests whether a pseudo-legal move gives a check.
+bool Position::gives_check(Move m) const {
+    assert(m.is_ok());
+    assert(color_of(moved_piece(m)) == sideToMove);
+
+    Square from = m.from_sq();
+    Square to = m.to_sq();
+    Color us = sideToMove;
+    Square ksq = square<KING>(~us);
+
+    // Is there a direct check?
+    if (m.type_of() != CASTLING && (check_squares(type_of(moved_piece(m))) & to)) {
+        return true;
+    }
+
+    // Is there a discovered check? A castling king moves along its rank, so it can only discover
+    // a check on a line crossing that rank.
+    if (blockers_for_king(~us) & from) {
+        return !(line_bb(from, to) & ksq) || m.type_of() == CASTLING;
+    }
+
+    switch (m.type_of()) {
+        case NORMAL: return false;
+
+        case PROMOTION: return attacks_bb(m.promotion_type(), to, pieces() ^ from) & ksq;
+
+        // The captured pawn may discover a check, the same way a castling king can.
+        case EN_PASSANT: {
+            Square capsq = to - pawn_push(us);
+            Bitboard b = (pieces() ^ from ^ capsq) | to;
+
+            return (attacks_bb<ROOK>(ksq, b) & pieces<ROOK, QUEEN>(us)) |
+                   (attacks_bb<BISHOP>(ksq, b) & pieces<BISHOP, QUEEN>(us));
+        }
+
+        default: {  // CASTLING
+            Direction step = from > to ? WEST : EAST;
+            Square kto = from + 2 * step;
+            Square rto = kto - step;
+            Bitboard b = (pieces() ^ from ^ to) | kto | rto;
+
+            return attacks_bb<ROOK>(rto, b) & ksq;
+        }
+    }
+}
+
+// A swap list: gain[d] is the material won by the side making the d-th capture if the exchange
+// stops right after it, the list is then folded back from the last capture, each side choosing
+// between capturing and standing pat. Sliders behind a capturing piece join in once it leaves its
+// square, pieces pinned to their king leave their pin line only once the pinner is gone, and the
+// king only captures a piece nothing defends any more. Castling never loses material.
+bool Position::see_ge(Move m, Value threshold) const {
+    assert(m.is_ok());
+
+    if (m.type_of() == CASTLING) {
+        return VALUE_ZERO >= threshold;
+    }
+
+    const Square from = m.from_sq();
+    const Square to = m.to_sq();
+
+    // The destination square is left out of the occupancy: it does not block any attack on
+    // itself, and a pinner captured there no longer pins.
+    Bitboard occupied = pieces() & ~square_bb(from) & ~square_bb(to);
+    Value gain[32];
+    Value onSquare;  // The value of the piece last moved to the destination square
+
+    switch (m.type_of()) {
+        case PROMOTION:
+            onSquare = PieceValue[m.promotion_type()];
+            gain[0] = PieceValue[type_of(piece_on(to))] + onSquare - PawnValue;
+            break;
+
+        case EN_PASSANT:
+            occupied ^= to - pawn_push(sideToMove);
+            onSquare = PawnValue;
+            gain[0] = PawnValue;
+            break;
+
+        default:
+            onSquare = PieceValue[type_of(piece_on(from))];
+            gain[0] = PieceValue[type_of(piece_on(to))];
+            break;
+    }
+
+    // A pawn capturing on the last rank promotes to a queen
+    const Value promotionGain = (to & (Rank1BB | Rank8BB)) ? QueenValue - PawnValue : VALUE_ZERO;
+
+    // The opponent may decline to recapture, and recapturing wins at most the moved piece back
+    if (gain[0] < threshold) {
+        return false;
+    }
+    if (gain[0] - onSquare - promotionGain >= threshold) {
+        return true;
+    }
+
+    const Bitboard bishops = pieces<BISHOP, QUEEN>();
+    const Bitboard rooks = pieces<ROOK, QUEEN>();
+    Bitboard attackers = attackers_to(to, occupied) & occupied;
+    Color stm = sideToMove;
+    int d = 0;
+
+    while (true) {
+        stm = ~stm;
+        attackers &= occupied;
+
+        // A piece pinned by a slider still on the board only captures along the line of its pin
+        Bitboard stmAttackers = attackers & pieces(stm);
+        if (stmAttackers & blockers_for_king(stm)) {
+            const Square ksq = square<KING>(stm);
+            Bitboard pinned = 0;
+            for (Bitboard b = st.pinners[~stm] & occupied; b;) {
+                pinned |= between_bb(ksq, pop_lsb(b));
+            }
+            stmAttackers &= ~(pinned & blockers_for_king(stm)) | line_bb(ksq, to);
+        }
+        if (!stmAttackers) {
+            break;
+        }
+
+        PieceType pt = PAWN;
+        while (!(stmAttackers & byTypeBB[pt])) {
+            ++pt;
+        }
+
+        // Any attacker left, including one behind the king, defends the square
+        if (pt == KING && (attackers_to(to, occupied ^ square<KING>(stm)) & pieces(~stm) & occupied)) {
+            break;
+        }
+
+        assert(d + 1 < int(std::size(gain)));
+        ++d;
+        gain[d] = onSquare - gain[d - 1];
+        onSquare = PieceValue[pt];
+
+        if (pt == PAWN && promotionGain) {
+            gain[d] += promotionGain;
+            onSquare = QueenValue;
+        }
+
+        // Even unanswered, the capture would do worse than stopping: the exchange ends here
+        if (gain[d] < -gain[d - 1]) {
+            --d;
+            break;
+        }
+
+        occupied ^= lsb(stmAttackers & byTypeBB[pt]);
+
+        // X-rays: a pawn, bishop or queen leaving the square uncovers diagonal sliders behind it,
+        // a rook or queen straight ones. Knights and kings uncover nothing.
+        if (pt == PAWN || pt == BISHOP || pt == QUEEN) {
+            attackers |= attacks_bb<BISHOP>(to, occupied) & bishops;
+        }
+        if (pt == ROOK || pt == QUEEN) {
+            attackers |= attacks_bb<ROOK>(to, occupied) & rooks;
+        }
+    }
+
+    for (; d > 0; --d) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+
+    return gain[0] >= threshold;
+}
+
+Key Position::key_after(Move m) const {
+    Square from = m.from_sq();
+    Square to = m.to_sq();
+    Piece pc = piece_on(from);
+    Piece placed = m.type_of() == PROMOTION ? make_piece(sideToMove, m.promotion_type()) : pc;
+    Key k = st.key ^ Zobrist::side ^ Zobrist::psq[pc][from] ^ Zobrist::psq[placed][to];
+
+    if (st.epSquare != SQ_NONE) {
+        k ^= Zobrist::enpassant[file_of(st.epSquare)];
+    }
+
+    // Castling moves capture their own rook, en passant captures on another square
+    if (m.type_of() == NORMAL || m.type_of() == PROMOTION) {
+        if (Piece captured = piece_on(to); captured != NO_PIECE) {
+            k ^= Zobrist::psq[captured][to];
+        }
+    } else if (m.type_of() == EN_PASSANT) {
+        k ^= Zobrist::psq[piece_on(to - pawn_push(sideToMove))][to - pawn_push(sideToMove)];
+    }
+
+    return k;
+}
+
+namespace {
+
+// Copies src into dst. The lazily computed fields are skipped while all of them are stale, which
+// is the common case at leaf nodes.
+void copy_state(StateInfo& dst, const StateInfo& src) {
+    constexpr size_t lazyStart = offsetof(StateInfo, blockersForKing);
+
+    std::memcpy(&dst, &src, lazyStart);
+    if (src.dirtyBlockers != ((1 << WHITE) | (1 << BLACK)) || !src.dirtyCheckSquares) {
+        std::memcpy(reinterpret_cast<char*>(&dst) + lazyStart,
+                    reinterpret_cast<const char*>(&src) + lazyStart,
+                    sizeof(StateInfo) - lazyStart);
+    }
+}
+
+}  // namespace
+
+// Saves the current state into prevSt and links the current state to it.
+void Position::save_state(StateInfo& prevSt) {
+    copy_state(prevSt, st);
+    st.previous = &prevSt;
+}
+
+// Restores the previous state, including whatever was computed lazily for it.
+void Position::restore_state() {
+    copy_state(st, *st.previous);
+}
+
+// Makes a move and saves the previous state into a StateInfo object supplied by the caller. The
+// move is assumed to be legal. The StateInfo must outlive the matching call to unmake_move(). The
+// checkers are found with a full attacker scan of the enemy king.
+void Position::make_move(Move m, StateInfo& prevSt) {
+    make_move(m, prevSt, true);
+}
+
+// Same as above, with a hint from gives_check(): when the move is known not to give check, the
+// attacker scan is skipped.
+void Position::make_move(Move m, StateInfo& prevSt, bool givesCheck) {
+    assert(legal(m));
+
+    save_state(prevSt);
+    do_move(m, givesCheck);
+}
+
 void Position::make_move(Move m) {
     assert(legal(m));
 
+    st.previous = nullptr;
+    do_move(m, true);
+}
+
+// Updates the board and the current state in place.
+void Position::do_move(Move m, bool givesCheck) {
     Square from = m.from_sq();
     Square to = m.to_sq();
     Color us = sideToMove;
     Color them = ~us;
+    Piece pc = moved_piece(m);
+    Key k = st.key ^ Zobrist::side;
+    DirtyPiece& dp = st.dirtyPiece;
+
+    // The moving piece comes first, a promotion turns it into a removal below
+    dp.count = 1;
+    dp.piece[0] = pc;
+    dp.from[0] = from;
+    dp.to[0] = to;
+
+    // Reset the en passant square
+    if (st.epSquare != SQ_NONE) {
+        k ^= Zobrist::enpassant[file_of(st.epSquare)];
+    }
 
-    // Init and set a new state
-    StateInfo* newState = new StateInfo{*st};
-    newState->rule50 = st->rule50 + 1;
-    newState->previous = st;
-    st = newState;
-    st->capturedPiece = NO_PIECE;
-    st->epSquare = SQ_NONE;
+    ++st.rule50;
+    ++st.pliesFromNull;
+    st.capturedPiece = NO_PIECE;
+    st.epSquare = SQ_NONE;
 
     if (!is_empty(to) && m.type_of() != EN_PASSANT && m.type_of() != CASTLING) {
-        st->capturedPiece = piece_on(to);
+        Piece captured = piece_on(to);
+        st.capturedPiece = captured;
         remove_piece(to);
+
+        dp.count = 2;
+        dp.piece[1] = captured;
+        dp.from[1] = to;
+        dp.to[1] = SQ_NONE;
+
+        k ^= Zobrist::psq[captured][to];
+        st.materialKey ^= Zobrist::psq[captured][count(captured)];
+        if (type_of(captured) == PAWN) {
+            st.pawnKey ^= Zobrist::psq[captured][to];
+        }
+        st.rule50 = 0;
     }
 
     // Check and handle double pawn pushes
-    if (type_of(moved_piece(m)) == PAWN) {
+    if (type_of(pc) == PAWN) {
+        st.rule50 = 0;
         if ((rank_of(from) == relative_rank(us, RANK_2)) &&
             (rank_of(to) == relative_rank(us, RANK_4))) {
             Square epTarget = from + pawn_push(us);
-            st->epSquare = (attackers_to(epTarget) & pieces<PAWN>(them)) ? epTarget : SQ_NONE;
+            if (attackers_to(epTarget) & pieces<PAWN>(them)) {
+                st.epSquare = epTarget;
+                k ^= Zobrist::enpassant[file_of(epTarget)];
+            }
         }
     }
 
     if (m.type_of() == EN_PASSANT) {
-        assert(moved_piece(m) == make_piece(us, PAWN));
+        assert(pc == make_piece(us, PAWN));
         assert(piece_on(to) == NO_PIECE);
         assert(rank_of(to) == relative_rank(us, RANK_6));
 
         Square capsq = to - pawn_push(us);
-        st->capturedPiece = piece_on(capsq);
+        Piece captured = piece_on(capsq);
+        st.capturedPiece = captured;
 
         remove_piece(capsq);
         move_piece(from, to);
+
+        dp.count = 2;
+        dp.piece[1] = captured;
+        dp.from[1] = capsq;
+        dp.to[1] = SQ_NONE;
+
+        k ^= Zobrist::psq[captured][capsq] ^ Zobrist::psq[pc][from] ^ Zobrist::psq[pc][to];
+        st.pawnKey ^= Zobrist::psq[captured][capsq] ^ Zobrist::psq[pc][from] ^
+                       Zobrist::psq[pc][to];
+        st.materialKey ^= Zobrist::psq[captured][count(captured)];
     } else if (m.type_of() == CASTLING) {
-        assert(moved_piece(m) == make_piece(us, KING));
+        assert(pc == make_piece(us, KING));
         assert(piece_on(to) == make_piece(us, ROOK));
 
         Direction step = from > to ? WEST : EAST;
+        Piece rook = piece_on(to);
 
         // King moves 2 steps towards the rook
         Square ksq = from + 2 * step;
@@ -288,8 +812,17 @@ void Position::make_move(Move m) {
         // Rook is placed on the opposite side of the king
         Square rsq = ksq - step;
         move_piece(to, rsq);
+
+        dp.to[0] = ksq;
+        dp.count = 2;
+        dp.piece[1] = rook;
+        dp.from[1] = to;
+        dp.to[1] = rsq;
+
+        k ^= Zobrist::psq[pc][from] ^ Zobrist::psq[pc][ksq];
+        k ^= Zobrist::psq[rook][to] ^ Zobrist::psq[rook][rsq];
     } else if (m.type_of() == PROMOTION) {
-        assert(moved_piece(m) == make_piece(us, PAWN));
+        assert(pc == make_piece(us, PAWN));
         assert(rank_of(to) == relative_rank(us, RANK_8));
         assert(m.promotion_type() != NO_PIECE_TYPE);
 
@@ -298,27 +831,68 @@ void Position::make_move(Move m) {
         // Manually move and replace the pawn, to ensure the correct type is placed.
         remove_piece(from);
         put_piece(p, to);
+
+        dp.to[0] = SQ_NONE;
+        dp.piece[dp.count] = p;
+        dp.from[dp.count] = SQ_NONE;
+        dp.to[dp.count] = to;
+        ++dp.count;
+
+        k ^= Zobrist::psq[pc][from] ^ Zobrist::psq[p][to];
+        st.pawnKey ^= Zobrist::psq[pc][from];
+        st.materialKey ^= Zobrist::psq[pc][count(pc)] ^ Zobrist::psq[p][count(p) - 1];
     } else {
         move_piece(from, to);
+
+        k ^= Zobrist::psq[pc][from] ^ Zobrist::psq[pc][to];
+        if (type_of(pc) == PAWN) {
+            st.pawnKey ^= Zobrist::psq[pc][from] ^ Zobrist::psq[pc][to];
+        }
     }
 
     // Remove castling rights if any key squares are affected
-    if (CastlingSquares & (from | to)) {
+    if (st.castlingRights && (CastlingSquares & (from | to))) {
+        k ^= Zobrist::castling[st.castlingRights];
         remove_castling_rights(cr_from_sq(from));
         remove_castling_rights(cr_from_sq(to));
+        k ^= Zobrist::castling[st.castlingRights];
     }
 
-    // Update state
-    update_slider_blockers(WHITE);
-    update_slider_blockers(BLACK);
-    st->checkersBB = attackers_to(square<KING>(them)) & pieces(us);
+    st.key = k;
+
+    // The same position can only have occurred an even number of plies ago, with no capture, pawn
+    // move or null move since. The chain ends early after a copy-make or at the setup position.
+    st.repetition = 0;
+    const StateInfo* stp = st.previous;
+    for (int i = 2; i <= std::min(st.rule50, st.pliesFromNull) && stp && stp->previous; i += 2) {
+        stp = stp->previous;
+        if (stp->key == k) {
+            st.repetition = stp->repetition ? -i : i;
+            break;
+        }
+        stp = stp->previous;
+    }
+
+    // Update state, slider blockers are computed on demand.
+    st.dirtyBlockers = (1 << WHITE) | (1 << BLACK);
+    st.dirtyCheckSquares = true;
+    st.checkersBB = givesCheck ? attackers_to(square<KING>(them)) & pieces(us) : 0;
 
     ++gamePly;
     sideToMove = them;
+
+    MY_ASSERT(st.key == compute_key(), "m: " << m << " pos:\n" << *this);
+    MY_ASSERT(st.pawnKey == compute_pawn_key(), "m: " << m << " pos:\n" << *this);
+    MY_ASSERT(st.materialKey == compute_material_key(), "m: " << m << " pos:\n" << *this);
+    MY_ASSERT(psq == compute_psq_score(), "m: " << m << " pos:\n" << *this);
+    MY_ASSERT(st.checkersBB == (attackers_to(square<KING>(them)) & pieces(us)),
+              "m: " << m << " pos:\n"
+                    << *this);
 }
 
 void Position::unmake_move(Move m) {
     assert(m.is_ok());
+    assert(st.previous);
 
     Square from = m.from_sq();
     Square to = m.to_sq();
@@ -328,7 +902,7 @@ void Position::unmake_move(Move m) {
 
     if (m.type_of() == EN_PASSANT) {
         move_piece(to, from);
-        put_piece(st->capturedPiece, to - pawn_push(us));
+        put_piece(st.capturedPiece, to - pawn_push(us));
     } else if (m.type_of() == CASTLING) {
         Direction step = from > to ? WEST : EAST;
         Square ksq = from + 2 * step;
@@ -343,14 +917,58 @@ void Position::unmake_move(Move m) {
         move_piece(to, from);
     }
 
-    if (st->capturedPiece != NO_PIECE && m.type_of() != EN_PASSANT) {
-        put_piece(st->capturedPiece, to);
+    if (st.capturedPiece != NO_PIECE && m.type_of() != EN_PASSANT) {
+        put_piece(st.capturedPiece, to);
     }
 
-    StateInfo* si = st;
-    st = st->previous;
-    delete si;
+    MY_ASSERT(psq == compute_psq_score(), "m: " << m << " pos:\n" << *this);
+
+    restore_state();
 
     --gamePly;
     sideToMove = us;
 }
+
+void Position::make_null_move(StateInfo& prevSt) {
+    assert(!checkers());
+
+    save_state(prevSt);
+
+    if (st.epSquare != SQ_NONE) {
+        st.key ^= Zobrist::enpassant[file_of(st.epSquare)];
+        st.epSquare = SQ_NONE;
+    }
+
+    st.key ^= Zobrist::side;
+    ++st.rule50;
+    st.pliesFromNull = 0;
+    st.repetition = 0;
+    st.capturedPiece = NO_PIECE;
+    st.dirtyPiece.count = 0;
+
+    // The board is unchanged, so are the slider blockers. The check squares are those of the
+    // other king.
+    st.dirtyCheckSquares = true;
+
+    sideToMove = ~sideToMove;
+
+    MY_ASSERT(st.key == compute_key(), "pos:\n" << *this);
+}
+
+void Position::unmake_null_move() {
+    assert(st.previous);
+    assert(!checkers());
+
+    restore_state();
+    sideToMove = ~sideToMove;
+}
+
+// Both are answered from the current state only, the repetition was found when making the move.
+// Checkmate takes precedence over the fifty-move rule.
+bool Position::is_draw(int ply) const {
+    if (st.rule50 > 99 && (!checkers() || MoveList<LEGAL>(*this).size())) {
+        return true;
+    }
+
+    return st.repetition && st.repetition < ply;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <array>
+#include <deque>
 #include <string>
+#include <type_traits>
 #include "bitboard.h"
+#include "psqt.h"
 #include "types.h"
 
 constexpr auto CastlingPaths = []() {
@@ -29,47 +32,89 @@ constexpr Bitboard RookSquares = SQ_A1 | SQ_A8 | SQ_H1 | SQ_H8;
 constexpr Bitboard KingSquares = SQ_E1 | SQ_E8;
 constexpr Bitboard CastlingSquares = KingSquares | RookSquares;
 
-struct StateInfo {
-    StateInfo() = default;
+// The pieces changed by a move, for evaluators that update incrementally. A move changes at most
+// three pieces: the moving one, a captured one and the castling rook. A removed piece has `to`
+// SQ_NONE, an added one (the promoted piece) has `from` SQ_NONE.
+struct DirtyPiece {
+    uint8_t count;
+    Piece piece[3];
+    Square from[3];
+    Square to[3];
+};
 
-    Square epSquare = SQ_NONE;
+// StateInfo holds the parts of a position that are not derived from the board in a cheap way.
+// The current state lives inside the Position, make_move() saves the previous one into storage
+// owned by its caller, typically a fixed-depth stack in the search or perft driver, so making a
+// move never allocates and the states form a chain back to the root through `previous`. The lazily
+// computed fields are only copied once some of them have been computed.
+struct StateInfo {
+    // Updated incrementally when making a move
+    Key pawnKey;
+    Key materialKey;
     CastlingRights castlingRights;
     int rule50;
-    Bitboard checkersBB{};
-    Bitboard blockersForKing[COLOR_NB];
-    Bitboard pinners[COLOR_NB];
-    Piece capturedPiece = NO_PIECE;
+    int pliesFromNull;
+
+    // Recomputed when making a move. repetition is the distance in plies to the last occurrence
+    // of the same position, 0 if there is none, negative if that one was a repetition too.
+    Key key;
+    int repetition;
+    Square epSquare;
+    Piece capturedPiece;
+    Bitboard checkersBB;
     StateInfo* previous;
+    DirtyPiece dirtyPiece;
+
+    // Computed lazily on first use. Bit c of dirtyBlockers is set while blockersForKing[c] and
+    // pinners[~c] are stale, dirtyCheckSquares while checkSquares are; leaf nodes that never ask
+    // for them never pay for them.
+    mutable uint8_t dirtyBlockers;
+    mutable bool dirtyCheckSquares;
+    mutable Bitboard blockersForKing[COLOR_NB];
+    mutable Bitboard pinners[COLOR_NB];
+    mutable Bitboard checkSquares[PIECE_TYPE_NB];
+};
+
+// A list to keep track of the position states along the setup moves (from the start position to
+// the position just before the search starts). A deque keeps references to its elements valid
+// while growing, so the `previous` chain stays intact.
+using StateList = std::deque<StateInfo>;
+
+// A position in 32 bytes, for keeping millions of them in memory or on disk. The pieces are
+// listed one nibble each, in the order of the squares set in occupied. Keys, checkers and the
+// state history are not stored, unpacking recomputes the first two.
+struct PackedPosition {
+    Bitboard occupied;
+    uint8_t pieces[16];
+    uint16_t rule50;
+    uint16_t gamePly;
+    uint8_t sideToMove;
+    uint8_t castlingRights;
+    uint8_t epSquare;
+
+    bool operator==(const PackedPosition& rhs) const = default;
 };
 
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition size incorrect");
+
 /// FEN string: position, active color, castling rights, en passant targets
 /// (optional), halfmove clock, fullmove number ref:
 /// https://www.chess.com/terms/fen-chess
 constexpr auto fen_start_position = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
+// Position is trivially copyable and holds no pointer into itself, so a copy is a plain memcpy of
+// a few cache lines. Copies share the state history of the original.
 class Position {
    public:
     Position(std::string fenStr = fen_start_position);
-    ~Position() { delete st; }
-    Position(const Position& rhs) : st(new StateInfo(*rhs.st)) {}
-    Position& operator=(const Position& rhs) {
-        if (this != &rhs) {
-            st = new StateInfo{*rhs.st};
-        }
-        return *this;
-    }
-    Position(Position&& rhs) : st(rhs.st) { rhs.st = nullptr; }
-    Position& operator=(Position&& rhs) {
-        if (this != &rhs) {
-            delete st;
-            st = rhs.st;
-            rhs.st = nullptr;
-        }
-        return *this;
-    }
+    explicit Position(const PackedPosition& packed);
 
     std::string as_fen() const;
 
+    PackedPosition pack() const;
+    // Replaces this position with the packed one, dropping the state history
+    void unpack(const PackedPosition& packed);
+
     // All pieces
     Bitboard pieces() const;
     Bitboard pieces(Color c) const;
@@ -79,14 +124,39 @@ class Position {
     Bitboard pieces(Color c) const;
 
     Piece piece_on(Square s) const;
+    int count(Piece pc) const;
+    // Pt may be ALL_PIECES, for all pieces of the color
+    template <PieceType Pt>
+    int count(Color c) const;
+    template <PieceType Pt>
+    int count() const;
     template <PieceType Pt>
     Square square(Color c) const;
 
     bool legal(Move m) const;
     bool pseudo_legal(Move m) const;
 
+    bool gives_check(Move m) const;
+    // Whether m captures or promotes to a queen, as the moves of generate<TACTICALS>()
+    bool tactical(Move m) const;
+    // Static exchange evaluation: whether the captures on the destination square of m, both
+    // sides taking with their least valuable piece and free to stop at any point, win at least
+    // threshold for the side to move.
+    bool see_ge(Move m, Value threshold = VALUE_ZERO) const;
+
+    void make_move(Move m, StateInfo& prevSt);
+    void make_move(Move m, StateInfo& prevSt, bool givesCheck);
+    // Copy-make: the previous state is dropped, so the move cannot be unmade. Used as
+    // `Position child = parent; child.make_move(m);`
     void make_move(Move m);
     void unmake_move(Move m);
+    // Passes the turn to the opponent, as used by null move pruning. Not allowed in check.
+    void make_null_move(StateInfo& prevSt);
+    void unmake_null_move();
+    // Whether the position is drawn by the fifty-move rule or by repetition. A repetition within
+    // the last ply plies, inside the search tree, counts the first time; an earlier one only when
+    // it is the third occurrence of the position.
+    bool is_draw(int ply) const;
     Piece moved_piece(Move m) const;
 
     bool is_empty(Square s) const;
@@ -99,23 +169,48 @@ class Position {
     Color side_to_move() const;
     Bitboard checkers() const;
     Bitboard blockers_for_king(Color c) const;
+    Bitboard check_squares(PieceType pt) const;
     Square ep_square() const;
+    Key key() const;
+    // The key after making m, cheap enough to prefetch the hash entry of the child before making
+    // the move. Exact unless m castles, changes castling rights or allows an en passant capture.
+    Key key_after(Move m) const;
+    Key pawn_key() const;
+    Key material_key() const;
+    // The material and piece-square score of all pieces, from white's point of view
+    Score psq_score() const;
     std::array<Piece, SQUARE_NB> board() const;
     const StateInfo* state() const;
+    // The pieces changed by the last move, none after a null move
+    const DirtyPiece& dirty_piece() const;
 
    private:
     std::array<Piece, SQUARE_NB> board_{};
     std::array<Bitboard, COLOR_NB> byColorBB{};
     std::array<Bitboard, PIECE_TYPE_NB> byTypeBB{};
-    StateInfo* st{};
-    Color sideToMove;
-    int gamePly;
+    // Indexed by piece, the total of each color at make_piece(c, ALL_PIECES)
+    std::array<uint8_t, PIECE_NB> pieceCount{};
+    StateInfo st{};
+    Color sideToMove = WHITE;
+    int gamePly = 0;
+    Score psq = SCORE_ZERO;
 
     void put_piece(Piece p, Square s);
     void remove_piece(Square s);
     void move_piece(Square from, Square to);
-    void update_slider_blockers(Color c);
-    void update_state_info(StateInfo* newState);
+    void update_slider_blockers(Color c) const;
+    void update_check_squares() const;
+    void save_state(StateInfo& prevSt);
+    void restore_state();
+    void do_move(Move m, bool givesCheck);
+    void set_state();
+
+    // From-scratch key and score computations, used when setting up a position and to verify
+    // the incrementally updated ones in debug builds.
+    Key compute_key() const;
+    Key compute_pawn_key() const;
+    Key compute_material_key() const;
+    Score compute_psq_score() const;
 
     void set_castling_rights(CastlingRights cr);
     void remove_castling_rights(CastlingRights cr);
@@ -133,20 +228,65 @@ class Position {
     bool attackers_to_exist(Square s, Bitboard occupied, Color c) const;
 };
 
+static_assert(std::is_trivially_copyable_v<Position>, "Position must be trivially copyable");
+static_assert(sizeof(Position) <= 6 * 64, "Position size incorrect");
+
 inline Color Position::side_to_move() const {
     return sideToMove;
 }
 
 inline Bitboard Position::blockers_for_king(Color c) const {
-    return st->blockersForKing[c];
+    if (st.dirtyBlockers & (1 << c)) {
+        update_slider_blockers(c);
+    }
+    return st.blockersForKing[c];
+}
+
+// Returns the squares from which a piece of the given type would give check to the king of the
+// side not to move.
+inline Bitboard Position::check_squares(PieceType pt) const {
+    if (st.dirtyCheckSquares) {
+        update_check_squares();
+    }
+    return st.checkSquares[pt];
 }
 
 inline Bitboard Position::checkers() const {
-    return st->checkersBB;
+    return st.checkersBB;
 }
 
 inline Square Position::ep_square() const {
-    return st->epSquare;
+    return st.epSquare;
+}
+
+inline Key Position::key() const {
+    return st.key;
+}
+
+inline Key Position::pawn_key() const {
+    return st.pawnKey;
+}
+
+inline Key Position::material_key() const {
+    return st.materialKey;
+}
+
+inline Score Position::psq_score() const {
+    return psq;
+}
+
+inline int Position::count(Piece pc) const {
+    return pieceCount[pc];
+}
+
+template <PieceType Pt>
+inline int Position::count(Color c) const {
+    return pieceCount[make_piece(c, Pt)];
+}
+
+template <PieceType Pt>
+inline int Position::count() const {
+    return count<Pt>(WHITE) + count<Pt>(BLACK);
 }
 
 inline std::array<Piece, SQUARE_NB> Position::board() const {
@@ -158,6 +298,12 @@ inline Square Position::square(Color c) const {
     return lsb(pieces<Pt>(c));
 }
 
+// A castling king moves onto its own rook, which is not a capture
+inline bool Position::tactical(Move m) const {
+    return (m.type_of() != CASTLING && !is_empty(m.to_sq())) || m.type_of() == EN_PASSANT ||
+           (m.type_of() == PROMOTION && m.promotion_type() == QUEEN);
+}
+
 inline Piece Position::moved_piece(Move m) const {
     return piece_on(m.from_sq());
 }
@@ -212,13 +358,17 @@ inline bool Position::attackers_to_exist(Square s, Bitboard occupied, Color c) c
 }
 
 inline void Position::set_castling_rights(CastlingRights cr) {
-    st->castlingRights |= cr;
+    st.castlingRights |= cr;
 }
 
 inline void Position::remove_castling_rights(CastlingRights cr) {
-    st->castlingRights &= ~cr;
+    st.castlingRights &= ~cr;
 }
 
 inline const StateInfo* Position::state() const {
-    return st;
+    return &st;
+}
+
+inline const DirtyPiece& Position::dirty_piece() const {
+    return st.dirtyPiece;
 }
@@ -52,6 +52,35 @@ std::string pretty(const Move m) {
                                         : "");
 }
 
+std::string uci(const Move m) {
+    if (m == Move::none())
+        return "(none)";
+
+    if (m == Move::null())
+        return "0000";
+
+    Square from = m.from_sq();
+    Square to = m.to_sq();
+
+    if (m.type_of() == CASTLING)
+        to = make_square(to > from ? FILE_G : FILE_C, rank_of(from));
+
+    std::string s = pretty(from) + pretty(to);
+
+    if (m.type_of() == PROMOTION)
+        s += pc_as_char(make_piece(BLACK, m.promotion_type()));
+
+    return s;
+}
+
+Move uci_to_move(const Position& pos, const std::string& str) {
+    for (const auto& m : MoveList<LEGAL>(pos))
+        if (str == uci(m))
+            return m;
+
+    return Move::none();
+}
+
 std::string pretty(const StateInfo& st) {
     std::string s = "Checkers:\n";
     s += pretty(st.checkersBB);
@@ -10,6 +10,12 @@ std::string pretty(const Position& p);
 std::string pretty(const Move m);
 std::string pretty(const StateInfo& st);
 
+/// Returns the move in long algebraic (UCI) notation, e.g. e2e4, e7e8q. Castling moves are
+/// printed as the king's two-square step, e.g. e1g1.
+std::string uci(const Move m);
+/// Returns the legal move matching the given UCI string, or Move::none() if there is none.
+Move uci_to_move(const Position& pos, const std::string& str);
+
 template <GenType T>
 std::string pretty(const MoveList<T>& moveList) {
     std::string s = "";
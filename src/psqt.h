@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include "types.h"
+
+namespace PSQT {
+
+constexpr Score S(int mg, int eg) {
+    return make_score(mg, eg);
+}
+
+// clang-format off
+constexpr std::array<Score, PIECE_TYPE_NB> PieceScore = {
+    SCORE_ZERO, S(82, 94), S(337, 281), S(365, 297), S(477, 512), S(1025, 936), SCORE_ZERO,
+    SCORE_ZERO};
+
+// Square bonuses of the white pieces by rank, from the A-file to the D-file. The E- to H-files
+// mirror them.
+constexpr Score Bonus[PIECE_TYPE_NB][RANK_NB][FILE_NB / 2] = {
+    {},
+    {},
+    {   // Knight
+        {S(-88, -48), S(-46, -32), S(-37, -24), S(-36, -10)},
+        {S(-38, -33), S(-20, -27), S(-13,  -9), S( -7,   4)},
+        {S(-30, -20), S( -8, -13), S(  3,  -4), S(  6,  14)},
+        {S(-17, -17), S(  4,  -1), S( 20,   6), S( 24,  14)},
+        {S(-17, -22), S(  6,  -8), S( 22,   4), S( 25,  19)},
+        {S( -4, -25), S( 11, -22), S( 29,  -8), S( 26,   8)},
+        {S(-33, -34), S(-13, -25), S(  2, -25), S( 18,   6)},
+        {S(-100,-50), S(-41, -44), S(-28, -28), S(-13,  -8)},
+    },
+    {   // Bishop
+        {S(-26, -28), S( -2, -15), S( -4, -18), S(-11,  -6)},
+        {S( -7, -18), S(  4,  -6), S(  9,  -8), S(  2,   0)},
+        {S( -3,  -8), S( 10,   0), S( -2,  -1), S(  8,   5)},
+        {S( -2, -10), S(  5,  -3), S( 12,   0), S( 19,   8)},
+        {S( -6,  -8), S( 14,   0), S( 11,  -7), S( 15,   7)},
+        {S( -8, -15), S(  3,   3), S(  0,   2), S(  5,   3)},
+        {S( -8, -15), S( -7, -10), S(  2,   0), S(  0,   0)},
+        {S(-24, -23), S(  0, -21), S( -7, -18), S(-11, -12)},
+    },
+    {   // Rook
+        {S(-15,  -4), S(-10,  -6), S( -7,  -5), S( -2,  -4)},
+        {S(-10,  -6), S( -6,  -4), S( -4,   0), S(  3,  -1)},
+        {S(-12,   3), S( -5,  -4), S(  0,  -1), S(  1,  -3)},
+        {S( -6,  -3), S( -2,   0), S( -2,  -4), S( -3,   3)},
+        {S(-13,  -2), S( -7,   4), S( -2,   3), S(  1,  -3)},
+        {S(-11,   3), S( -1,   0), S(  3,  -3), S(  6,   5)},
+        {S( -1,   2), S(  6,   2), S(  8,  10), S(  9,  -2)},
+        {S( -8,   9), S( -9,   0), S(  0,   9), S(  4,   6)},
+    },
+    {   // Queen
+        {S(  1, -34), S( -2, -28), S( -2, -23), S(  2, -13)},
+        {S( -1, -27), S(  2, -15), S(  4, -11), S(  6,  -2)},
+        {S( -1, -19), S(  3,  -9), S(  6,  -4), S(  3,   1)},
+        {S(  2, -11), S(  2,  -1), S(  4,   6), S(  4,  12)},
+        {S(  0, -14), S(  7,  -3), S(  6,   4), S(  2,  10)},
+        {S( -2, -19), S(  5,  -9), S(  3,  -6), S(  4,   0)},
+        {S( -2, -25), S(  3, -13), S(  5, -12), S(  4,  -4)},
+        {S( -1, -37), S( -1, -26), S(  0, -21), S( -1, -18)},
+    },
+    {   // King
+        {S(135,   0), S(163,  22), S(135,  42), S( 99,  38)},
+        {S(139,  26), S(151,  50), S(117,  66), S( 89,  67)},
+        {S( 97,  44), S(129,  65), S( 84,  84), S( 60,  87)},
+        {S( 82,  51), S( 95,  78), S( 69,  86), S( 49,  86)},
+        {S( 77,  48), S( 89,  83), S( 52,  99), S( 35,  99)},
+        {S( 61,  46), S( 72,  86), S( 40,  92), S( 15,  95)},
+        {S( 44,  23), S( 60,  60), S( 32,  58), S( 16,  65)},
+        {S( 29,   5), S( 44,  29), S( 22,  36), S(  0,  39)},
+    },
+};
+
+// Pawn structures are not symmetric, so pawns have a bonus for every square
+constexpr Score PawnBonus[RANK_NB][FILE_NB] = {
+    {},
+    {S(  1, -5), S(  1, -3), S(  5,  5), S(  9,  0), S(  8,  7), S(  9,  3), S(  3, -2), S( -2, -9)},
+    {S( -4, -5), S( -7, -5), S(  5, -5), S(  7,  2), S( 16,  2), S( 11,  1), S(  2, -3), S(-11, -2)},
+    {S( -2,  3), S(-11, -1), S(  3, -4), S( 10, -2), S( 20, -6), S(  8, -6), S(  2, -5), S( -4, -4)},
+    {S(  6,  5), S(  0,  2), S( -6,  2), S(  0, -2), S(  5, -2), S( -1, -2), S( -6,  7), S(  2,  4)},
+    {S(  2, 14), S( -6, 10), S( -3, 10), S( 11, 14), S( -4, 15), S( -2,  3), S( -7,  3), S( -4,  6)},
+    {S( -3,  0), S(  3, -5), S( -1,  6), S( -6, 10), S(  2, 12), S( -8,  9), S(  5,  2), S( -4,  3)},
+    {},
+};
+// clang-format on
+
+// psq[pc][s] is the material and square bonus of piece pc on square s from white's point of
+// view, so black pieces score negatively. The sum over all pieces is kept by Position.
+constexpr auto psq = []() {
+    std::array<std::array<Score, SQUARE_NB>, PIECE_NB> table{};
+
+    for (PieceType pt = PAWN; pt <= KING; ++pt) {
+        const Piece pc = make_piece(WHITE, pt);
+
+        for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+            const File f = std::min(file_of(s), File(FILE_H - file_of(s)));
+            const Score bonus =
+                pt == PAWN ? PawnBonus[rank_of(s)][file_of(s)] : Bonus[pt][rank_of(s)][f];
+
+            table[pc][s] = PieceScore[pt] + bonus;
+            table[~pc][flip_rank(s)] = -table[pc][s];
+        }
+    }
+
+    return table;
+}();
+
+}  // namespace PSQT
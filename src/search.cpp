@@ -0,0 +1,728 @@
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <unordered_map>
+#include "evaluate.h"
+#include "movegen.h"
+#include "movepick.h"
+#include "search.h"
+
+namespace Search {
+
+namespace {
+
+// The clock is read about once per this many nodes
+constexpr uint64_t TimeCheckInterval = 1024;
+
+constexpr int AspirationDepth = 4;
+constexpr Value AspirationDelta = 25;
+
+constexpr int NullMoveDepth = 3;
+constexpr int LmrDepth = 3;
+constexpr int LmrMoveCount = 4;
+
+// Mate scores are stored in the transposition table relative to the node rather than to the
+// root, so that they stay correct when the node is reached at another ply.
+constexpr Value value_to_tt(Value v, int ply) {
+    return v >= VALUE_MATE_IN_MAX_PLY ? v + ply : v <= VALUE_MATED_IN_MAX_PLY ? v - ply : v;
+}
+
+constexpr Value value_from_tt(Value v, int ply) {
+    return v == VALUE_NONE               ? v
+           : v >= VALUE_MATE_IN_MAX_PLY  ? v - ply
+           : v <= VALUE_MATED_IN_MAX_PLY ? v + ply
+                                         : v;
+}
+
+// Helper workers skip the depths of every other block of SkipSize[i] depths, starting at a
+// different SkipPhase[i] for each of them, so that the workers spread over several depths.
+constexpr int SkipSize[] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+constexpr int SkipPhase[] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+constexpr bool skips_depth(size_t workerId, int depth) {
+    const size_t i = (workerId - 1) % std::size(SkipSize);
+    return workerId > 0 && (depth + SkipPhase[i]) / SkipSize[i] % 2;
+}
+
+constexpr int permille(uint64_t part, uint64_t total) {
+    return total ? int(part * 1000 / total) : 0;
+}
+
+// Late move reductions grow with the logarithms of the depth and of the move number
+constexpr int reduction(int depth, int moveCount) {
+    return std::bit_width(unsigned(depth)) * std::bit_width(unsigned(moveCount)) / 6;
+}
+
+// A capture is not searched if even winning the captured piece with this margin on top leaves the
+// position below alpha
+constexpr Value DeltaMargin = 200;
+
+// Deeper into the quiescence search than this, only recaptures on the square of the last move
+// are searched, so that long series of even trades in crowded positions do not explode the tree
+constexpr int QSearchRecaptureDepth = -5;
+
+// The quiescence search shared by the workers and the standalone qsearch(), which evaluate and
+// count nodes differently. Context provides count_node(), evaluate(pos) and push(pos) and pop(),
+// called after every make_move and before every unmake_move.
+//
+// Out of check only captures and queen promotions are searched, on top of the static evaluation
+// as a lower bound: the side to move may stand pat instead. In check the evasions are searched
+// until one is found not to lose to mate. depth counts down from 0 at the horizon, lastTo is the
+// destination of the move leading here.
+template <typename Context>
+Value quiescence(
+    Context& ctx, Position& pos, Value alpha, Value beta, int ply, int depth, Square lastTo) {
+    ctx.count_node();
+
+    const bool inCheck = pos.checkers();
+
+    if (ply >= MAX_PLY) {
+        return inCheck ? VALUE_DRAW : ctx.evaluate(pos);
+    }
+
+    Value bestValue = -VALUE_INFINITE;
+    Value standPat = VALUE_NONE;
+
+    if (!inCheck) {
+        standPat = bestValue = ctx.evaluate(pos);
+        if (bestValue >= beta) {
+            return bestValue;
+        }
+        alpha = std::max(alpha, bestValue);
+    }
+
+    MovePicker picker(pos);
+    StateInfo st;
+    int moveCount = 0;
+
+    while (const Move m = picker.next_move()) {
+        if (!pos.legal(m)) {
+            continue;
+        }
+
+        ++moveCount;
+        const bool givesCheck = pos.gives_check(m);
+
+        if (!inCheck && depth <= QSearchRecaptureDepth && m.to_sq() != lastTo) {
+            continue;
+        }
+
+        // Delta pruning: checks and promotions may win more than the captured piece
+        if (!inCheck && !givesCheck && m.type_of() != PROMOTION) {
+            const Value victim = m.type_of() == EN_PASSANT
+                                     ? PawnValue
+                                     : PieceValue[type_of(pos.piece_on(m.to_sq()))];
+            const Value futility = standPat + victim + DeltaMargin;
+            if (futility <= alpha) {
+                bestValue = std::max(bestValue, futility);
+                continue;
+            }
+        }
+
+        // Once the side to move is known not to be mated, the quiet evasions and the captures
+        // losing material are not searched: the latter are refuted by the recapture.
+        if (bestValue > VALUE_MATED_IN_MAX_PLY &&
+            ((inCheck && !pos.tactical(m)) || !pos.see_ge(m))) {
+            continue;
+        }
+
+        pos.make_move(m, st, givesCheck);
+        ctx.push(pos);
+        const Value value = -quiescence(ctx, pos, -beta, -alpha, ply + 1, depth - 1, m.to_sq());
+        ctx.pop();
+        pos.unmake_move(m);
+
+        if (value > bestValue) {
+            bestValue = value;
+            if (value > alpha) {
+                if (value >= beta) {
+                    break;
+                }
+                alpha = value;
+            }
+        }
+    }
+
+    if (inCheck && moveCount == 0) {
+        return mated_in(ply);
+    }
+
+    return bestValue;
+}
+
+}  // namespace
+
+Value qsearch(Position& pos, Value alpha, Value beta, uint64_t* nodes) {
+    struct Context {
+        uint64_t nodes = 0;
+
+        void count_node() { ++nodes; }
+        Value evaluate(const Position& p) { return Eval::evaluate(p); }
+        void push(const Position&) {}
+        void pop() {}
+    } ctx;
+
+    const Value value = quiescence(ctx, pos, alpha, beta, 0, 0, SQ_NONE);
+    if (nodes) {
+        *nodes += ctx.nodes;
+    }
+    return value;
+}
+
+double Info::nps() const {
+    auto ns = std::max<int64_t>(elapsed.count(), 1);
+    return double(nodes) * 1e9 / double(ns);
+}
+
+Worker::Worker(Searcher& owner, size_t workerId) : searcher(owner), id(workerId) {
+    if (!is_main()) {
+        thread = std::thread(&Worker::idle_loop, this);
+    }
+}
+
+Worker::~Worker() {
+    if (!is_main()) {
+        {
+            std::lock_guard lock(mutex);
+            exit = true;
+        }
+        cv.notify_all();
+        thread.join();
+    }
+}
+
+void Worker::start_searching() {
+    {
+        std::lock_guard lock(mutex);
+        searching = true;
+    }
+    cv.notify_all();
+}
+
+void Worker::wait_for_search_finished() {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return !searching; });
+}
+
+void Worker::idle_loop() {
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        cv.wait(lock, [&] { return searching || exit; });
+        if (exit) {
+            return;
+        }
+
+        lock.unlock();
+        iterative_deepening();
+        lock.lock();
+
+        searching = false;
+        cv.notify_all();
+    }
+}
+
+Searcher::Searcher(size_t threads) : thread(&Searcher::idle_loop, this) {
+    set_threads(threads);
+}
+
+Searcher::~Searcher() {
+    {
+        std::lock_guard lock(mutex);
+        exit = true;
+        stopRequested = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+
+void Searcher::start(const Position& pos,
+                     const Limits& searchLimits,
+                     Listener iterationListener,
+                     Listener doneListener) {
+    wait();
+    {
+        std::lock_guard lock(mutex);
+        rootPos = pos;
+        limits = searchLimits;
+        onIteration = std::move(iterationListener);
+        onDone = std::move(doneListener);
+        info = Info{};
+        stopRequested = false;
+        running = true;
+    }
+    cv.notify_all();
+}
+
+void Searcher::stop() {
+    stopRequested = true;
+}
+
+void Searcher::wait() {
+    std::unique_lock lock(mutex);
+    cv.wait(lock, [&] { return !running; });
+}
+
+bool Searcher::searching() {
+    std::lock_guard lock(mutex);
+    return running;
+}
+
+void Searcher::set_threads(size_t threads) {
+    wait();
+    std::lock_guard lock(mutex);
+
+    workers.clear();
+    for (size_t id = 0; id < std::max<size_t>(threads, 1); ++id) {
+        workers.push_back(std::make_unique<Worker>(*this, id));
+    }
+}
+
+void Searcher::set_network(const NNUE::Network* net) {
+    wait();
+    std::lock_guard lock(mutex);
+    network = net;
+}
+
+void Searcher::set_hash_size(size_t mbSize) {
+    wait();
+    tt.resize(mbSize, std::thread::hardware_concurrency());
+}
+
+void Searcher::clear_hash() {
+    wait();
+    tt.clear(std::thread::hardware_concurrency());
+}
+
+Info Searcher::result() {
+    std::lock_guard lock(mutex);
+    return info;
+}
+
+void Searcher::idle_loop() {
+    std::unique_lock lock(mutex);
+
+    while (true) {
+        cv.wait(lock, [&] { return running || exit; });
+        if (exit) {
+            return;
+        }
+
+        lock.unlock();
+        run();
+        lock.lock();
+
+        running = false;
+        cv.notify_all();
+    }
+}
+
+// The main worker searches on this thread while the helpers search on theirs. Whenever the main
+// worker is done, because of the limits or because it was stopped, the helpers are stopped too.
+void Searcher::run() {
+    startTime = std::chrono::steady_clock::now();
+    tt.new_search();
+
+    for (size_t i = 1; i < workers.size(); ++i) {
+        workers[i]->start_searching();
+    }
+
+    workers[0]->iterative_deepening();
+
+    stopRequested = true;
+    for (size_t i = 1; i < workers.size(); ++i) {
+        workers[i]->wait_for_search_finished();
+    }
+
+    Info best = best_worker().last_iteration();
+
+    if (best.pv.empty()) {
+        MoveList<LEGAL> moves(rootPos);
+        if (moves.size()) {
+            best.pv = {*moves.begin()};
+        }
+    }
+
+    best.nodes = node_count();
+    best.elapsed = std::chrono::steady_clock::now() - startTime;
+    best.hashfull = tt.hashfull();
+
+    uint64_t pawnProbes = 0, pawnHits = 0;
+    for (const auto& w : workers) {
+        pawnProbes += w->pawn_table().probes();
+        pawnHits += w->pawn_table().hits();
+    }
+    best.pawnHits = permille(pawnHits, pawnProbes);
+
+    {
+        std::lock_guard lock(mutex);
+        info = best;
+    }
+
+    if (onDone) {
+        onDone(best);
+    }
+}
+
+void Searcher::report_iteration(const Info& iteration) {
+    {
+        std::lock_guard lock(mutex);
+        info = iteration;
+    }
+
+    if (onIteration) {
+        onIteration(iteration);
+    }
+}
+
+// Every worker with a result votes for its best move, with a weight growing with its depth and
+// with its score relative to the other workers. The deepest worker for the most voted move wins,
+// unless some worker has proven a mate, then the shortest one does.
+const Worker& Searcher::best_worker() const {
+    Value minScore = VALUE_INFINITE;
+    for (const auto& w : workers) {
+        if (!w->last_iteration().pv.empty()) {
+            minScore = std::min(minScore, w->last_iteration().score);
+        }
+    }
+
+    std::unordered_map<uint16_t, int64_t> votes;
+    for (const auto& w : workers) {
+        const Info& it = w->last_iteration();
+        if (!it.pv.empty()) {
+            votes[it.best_move().raw()] += int64_t(it.score - minScore + 14) * it.depth;
+        }
+    }
+
+    const Worker* best = workers[0].get();
+
+    for (const auto& w : workers) {
+        const Info& it = w->last_iteration();
+        const Info& bestIt = best->last_iteration();
+
+        if (it.pv.empty()) {
+            continue;
+        }
+
+        if (bestIt.pv.empty()) {
+            best = w.get();
+        } else if (it.score >= VALUE_MATE_IN_MAX_PLY || bestIt.score >= VALUE_MATE_IN_MAX_PLY) {
+            if (it.score > bestIt.score) {
+                best = w.get();
+            }
+        } else if (votes[it.best_move().raw()] > votes[bestIt.best_move().raw()] ||
+                   (it.best_move() == bestIt.best_move() && it.depth > bestIt.depth)) {
+            best = w.get();
+        }
+    }
+
+    return *best;
+}
+
+uint64_t Searcher::node_count() const {
+    uint64_t total = 0;
+    for (const auto& w : workers) {
+        total += w->node_count();
+    }
+    return total;
+}
+
+void Worker::iterative_deepening() {
+    nodes.store(0, std::memory_order_relaxed);
+    nextTimeCheck = TimeCheckInterval;
+    rootPos = searcher.rootPos;
+    previousPv.clear();
+    killers = {};
+    accumulators.reset();
+    pawnTable.reset_counters();
+    last = Info{};
+
+    const Limits& limits = searcher.limits;
+    const int maxDepth = limits.depth ? std::min(limits.depth, MAX_PLY - 1) : MAX_PLY - 1;
+    Value previousScore = VALUE_ZERO;
+
+    for (rootDepth = 1; rootDepth <= maxDepth; ++rootDepth) {
+        if (skips_depth(id, rootDepth)) {
+            continue;
+        }
+
+        Value alpha = -VALUE_INFINITE;
+        Value beta = VALUE_INFINITE;
+        Value delta = AspirationDelta;
+        Value score;
+
+        // Search a narrow window around the previous score first, widening it on the failing
+        // side until the score falls inside.
+        if (rootDepth >= AspirationDepth) {
+            alpha = std::max(previousScore - delta, -VALUE_INFINITE);
+            beta = std::min(previousScore + delta, VALUE_INFINITE);
+        }
+
+        while (true) {
+            score = search<true>(rootPos, alpha, beta, rootDepth, 0, false);
+            if (searcher.stopRequested) {
+                break;
+            }
+
+            if (score <= alpha) {
+                alpha = std::max(score - delta, -VALUE_INFINITE);
+            } else if (score >= beta) {
+                beta = std::min(score + delta, VALUE_INFINITE);
+            } else {
+                break;
+            }
+            delta += delta;
+        }
+
+        if (searcher.stopRequested) {
+            break;
+        }
+
+        previousScore = score;
+        previousPv.assign(pv[0].begin(), pv[0].begin() + pvLength[0]);
+
+        last.depth = rootDepth;
+        last.score = score;
+        last.nodes = node_count();
+        last.elapsed = std::chrono::steady_clock::now() - searcher.startTime;
+        last.pv = previousPv;
+
+        // The main worker reports the nodes of all workers
+        if (is_main()) {
+            Info iteration = last;
+            iteration.nodes = searcher.node_count();
+            iteration.hashfull = searcher.tt.hashfull();
+            iteration.pawnHits = permille(pawnTable.hits(), pawnTable.probes());
+            searcher.report_iteration(iteration);
+        }
+
+        // No moves or a forced mate, deeper iterations will not change the result
+        if (last.pv.empty() || std::abs(score) >= VALUE_MATE_IN_MAX_PLY) {
+            break;
+        }
+
+        // The next iteration takes longer than all the previous ones together, it would not
+        // complete in time.
+        if (is_main() && limits.time.count() && last.elapsed * 2 > limits.time) {
+            break;
+        }
+    }
+}
+
+bool Worker::should_stop() {
+    if (searcher.stopRequested.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    // Only the main worker applies the limits, once there is a result to return
+    if (!is_main() || rootDepth == 1) {
+        return false;
+    }
+
+    const Limits& limits = searcher.limits;
+    const uint64_t n = node_count();
+    bool stop = limits.nodes && searcher.node_count() >= limits.nodes;
+
+    if (!stop && limits.time.count() && n >= nextTimeCheck) {
+        nextTimeCheck = n + TimeCheckInterval;
+        stop = std::chrono::steady_clock::now() - searcher.startTime >= limits.time;
+    }
+
+    if (stop) {
+        searcher.stopRequested = true;
+    }
+
+    return stop;
+}
+
+// Recognized endings are evaluated by their own functions, with the network too
+Value Worker::evaluate(const Position& pos) {
+    if (!searcher.network) {
+        return Eval::evaluate(pos, pawnTable, materialTable);
+    }
+    const Material::Entry* me = materialTable.probe(pos);
+    return me->specialized_eval_exists() ? me->evaluate(pos)
+                                         : accumulators.evaluate(*searcher.network, pos);
+}
+
+// The quiescence search evaluates with the worker's network and counts its nodes with the others.
+// It does not check the limits, its trees are small.
+Value Worker::qsearch(Position& pos, Value alpha, Value beta, int ply) {
+    struct Context {
+        Worker& worker;
+
+        void count_node() {
+            worker.nodes.store(worker.nodes.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_relaxed);
+        }
+        Value evaluate(const Position& p) { return worker.evaluate(p); }
+        void push(const Position& p) { worker.accumulators.push(p.dirty_piece()); }
+        void pop() { worker.accumulators.pop(); }
+    } ctx{*this};
+
+    pvLength[ply] = ply;
+    return quiescence(ctx, pos, alpha, beta, ply, 0, SQ_NONE);
+}
+
+void Worker::update_pv(int ply, Move m) {
+    pv[ply][ply] = m;
+    std::copy(pv[ply + 1].begin() + ply + 1, pv[ply + 1].begin() + pvLength[ply + 1],
+              pv[ply].begin() + ply + 1);
+    pvLength[ply] = pvLength[ply + 1];
+}
+
+// Principal variation search: the first move is searched with the full window, the others with a
+// null window around alpha and searched again only if they turn out to be better.
+template <bool PvNode>
+Value Worker::search(Position& pos, Value alpha, Value beta, int depth, int ply, bool nullAllowed) {
+    pvLength[ply] = ply;
+
+    // The root always searches its moves, only the positions below it can be drawn by the history
+    if (ply > 0 && pos.is_draw(ply)) {
+        return VALUE_DRAW;
+    }
+
+    if (depth <= 0 || ply >= MAX_PLY) {
+        return qsearch(pos, alpha, beta, ply);
+    }
+
+    nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (should_stop()) {
+        return VALUE_ZERO;
+    }
+
+    const Color us = pos.side_to_move();
+    const bool inCheck = pos.checkers();
+    StateInfo st;
+
+    TT::Data ttData;
+    const bool ttHit = searcher.tt.probe(pos.key(), ttData);
+    const Value ttValue = ttHit ? value_from_tt(ttData.value, ply) : VALUE_NONE;
+
+    // A bound from an earlier search of this position at least as deep decides non-PV nodes
+    if (!PvNode && ttHit && ttData.depth >= depth && ttValue != VALUE_NONE &&
+        (ttData.bound & (ttValue >= beta ? TT::BOUND_LOWER : TT::BOUND_UPPER))) {
+        return ttValue;
+    }
+
+    Value eval = VALUE_NONE;
+
+    // Null move pruning: if passing the turn still fails high with a reduced search, a real move
+    // would too. Zugzwang makes this unsound when only pawns are left, so it is skipped then.
+    if (!PvNode && nullAllowed && !inCheck && depth >= NullMoveDepth &&
+        pos.pieces(us) != pos.pieces<PAWN, KING>(us)) {
+        eval = ttHit && ttData.eval != VALUE_NONE ? ttData.eval : evaluate(pos);
+    }
+
+    if (eval != VALUE_NONE && eval >= beta) {
+        int r = 3 + depth / 4;
+
+        pos.make_null_move(st);
+        accumulators.push(pos.dirty_piece());
+        Value nullValue = -search<false>(pos, -beta, -beta + 1, depth - r, ply + 1, false);
+        accumulators.pop();
+        pos.unmake_null_move();
+
+        if (searcher.stopRequested) {
+            return VALUE_ZERO;
+        }
+
+        if (nullValue >= beta) {
+            return nullValue >= VALUE_MATE_IN_MAX_PLY ? beta : nullValue;
+        }
+    }
+
+    // The move stored in the transposition table goes first, or else the move of the previous
+    // principal variation at this ply. The picker checks that it is pseudo-legal, which also
+    // rejects entries corrupted by concurrent writes.
+    const Move hint = ttHit && ttData.move       ? ttData.move
+                      : ply < int(previousPv.size()) ? previousPv[ply]
+                                                     : Move::none();
+    MovePicker picker(pos, hint, killers[ply]);
+
+    Value bestValue = -VALUE_INFINITE;
+    Move bestMove = Move::none();
+    int moveCount = 0;
+
+    while (const Move m = picker.next_move()) {
+        if (!pos.legal(m)) {
+            continue;
+        }
+
+        ++moveCount;
+        searcher.tt.prefetch(pos.key_after(m));
+
+        const bool givesCheck = pos.gives_check(m);
+        const bool quiet = !pos.tactical(m);
+        const int newDepth = depth - 1;
+        Value value;
+
+        pos.make_move(m, st, givesCheck);
+        accumulators.push(pos.dirty_piece());
+
+        if (moveCount == 1) {
+            value = -search<PvNode>(pos, -beta, -alpha, newDepth, ply + 1, true);
+        } else {
+            // Late move reductions: quiet moves late in the list rarely raise alpha, search them
+            // shallower first and at full depth only if they do.
+            int r = 0;
+            if (depth >= LmrDepth && moveCount >= LmrMoveCount && quiet && !inCheck && !givesCheck) {
+                r = std::clamp(reduction(depth, moveCount), 0, newDepth - 1);
+            }
+
+            value = -search<false>(pos, -alpha - 1, -alpha, newDepth - r, ply + 1, true);
+
+            if (value > alpha && r > 0) {
+                value = -search<false>(pos, -alpha - 1, -alpha, newDepth, ply + 1, true);
+            }
+
+            if (PvNode && value > alpha && value < beta) {
+                value = -search<true>(pos, -beta, -alpha, newDepth, ply + 1, true);
+            }
+        }
+
+        accumulators.pop();
+        pos.unmake_move(m);
+
+        if (searcher.stopRequested) {
+            return VALUE_ZERO;
+        }
+
+        if (value > bestValue) {
+            bestValue = value;
+
+            if (value > alpha) {
+                bestMove = m;
+
+                if (PvNode) {
+                    update_pv(ply, m);
+                }
+
+                // A quiet move refuting this position likely refutes its siblings too
+                if (value >= beta) {
+                    if (quiet && killers[ply][0] != m) {
+                        killers[ply][1] = killers[ply][0];
+                        killers[ply][0] = m;
+                    }
+                    break;
+                }
+
+                alpha = value;
+            }
+        }
+    }
+
+    if (moveCount == 0) {
+        return inCheck ? mated_in(ply) : VALUE_DRAW;
+    }
+
+    const TT::Bound bound = bestValue >= beta    ? TT::BOUND_LOWER
+                            : PvNode && bestMove ? TT::BOUND_EXACT
+                                                 : TT::BOUND_UPPER;
+    searcher.tt.store(pos.key(), value_to_tt(bestValue, ply), bound, depth, bestMove, eval);
+
+    return bestValue;
+}
+
+}  // namespace Search
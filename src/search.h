@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "material.h"
+#include "nnue.h"
+#include "pawns.h"
+#include "position.h"
+#include "tt.h"
+#include "types.h"
+
+namespace Search {
+
+/// Limits of a search, a zero limit is no limit. A search without any limit runs until stop() is
+/// called. The first iteration is always completed, unless the search is stopped explicitly.
+struct Limits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    std::chrono::milliseconds time{0};
+};
+
+/// The result of a completed iteration of iterative deepening.
+struct Info {
+    int depth = 0;
+    Value score = VALUE_NONE;
+    uint64_t nodes = 0;
+    std::chrono::nanoseconds elapsed{};
+    std::vector<Move> pv{};
+    // Permille of the transposition table written by this search
+    int hashfull = 0;
+    // Permille of the pawn table probes that hit, of the main worker for the iterations and of
+    // all workers for the final result. Zero when evaluating with a network.
+    int pawnHits = 0;
+
+    Move best_move() const { return pv.empty() ? Move::none() : pv.front(); }
+    double nps() const;
+};
+
+using Listener = std::function<void(const Info&)>;
+
+/// Quiescence search: resolves the captures, queen promotions and check evasions of pos until the
+/// position is quiet and returns its score from the point of view of the side to move, fail-soft
+/// within [alpha, beta]. It evaluates with the hand-written evaluation and shares no state, so
+/// any number of threads can score positions with it at once. pos is restored on return. If nodes
+/// is not null, the number of positions visited is added to it.
+Value qsearch(Position& pos,
+              Value alpha = -VALUE_INFINITE,
+              Value beta = VALUE_INFINITE,
+              uint64_t* nodes = nullptr);
+
+class Searcher;
+
+// The state of one search thread. Every worker searches its own copy of the root position, with
+// its own StateInfo stack, principal variation and accumulators; only the transposition table
+// is shared.
+class Worker {
+   public:
+    Worker(Searcher& searcher, size_t id);
+    ~Worker();
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    // Helper workers search on their own thread, started and joined with the worker. The main
+    // worker has none, it runs on the thread of the Searcher.
+    void start_searching();
+    void wait_for_search_finished();
+
+    void iterative_deepening();
+
+    uint64_t node_count() const { return nodes.load(std::memory_order_relaxed); }
+    // Only read while this worker is not searching, or by the worker itself
+    const Pawns::Table& pawn_table() const { return pawnTable; }
+    // The last completed iteration, if any
+    const Info& last_iteration() const { return last; }
+
+   private:
+    bool is_main() const { return id == 0; }
+    void idle_loop();
+    template <bool PvNode>
+    Value search(Position& pos, Value alpha, Value beta, int depth, int ply, bool nullAllowed);
+    Value qsearch(Position& pos, Value alpha, Value beta, int ply);
+    bool should_stop();
+    Value evaluate(const Position& pos);
+    void update_pv(int ply, Move m);
+
+    Searcher& searcher;
+    const size_t id;
+
+    std::mutex mutex{};
+    std::condition_variable cv{};
+    bool searching = false;
+    bool exit = false;
+
+    // Written by this worker only, read by the main worker for the node limit
+    std::atomic<uint64_t> nodes{0};
+    uint64_t nextTimeCheck = 0;
+    int rootDepth = 0;
+    Position rootPos{};
+    std::vector<Move> previousPv{};
+    NNUE::AccumulatorStack accumulators{};
+    Pawns::Table pawnTable{};
+    Material::Table materialTable{};
+    Info last{};
+
+    // Two quiet moves per ply that caused a beta cutoff, tried right after the good captures
+    std::array<std::array<Move, 2>, MAX_PLY + 1> killers{};
+
+    // Triangular principal variation table: pv[ply] holds the moves from ply to pvLength[ply]
+    std::array<std::array<Move, MAX_PLY + 1>, MAX_PLY + 1> pv{};
+    std::array<int, MAX_PLY + 1> pvLength{};
+
+    std::thread thread{};
+};
+
+// Searches on dedicated threads, so callers such as a GUI never block. The threads are started
+// with the Searcher and sleep between searches.
+//
+// With more than one thread the search is a Lazy SMP one: all workers search the same root
+// independently, helpers skipping some depths so that they are not all at the same one, and
+// share what they find through the transposition table. The main worker applies the limits and
+// stops the others; the final result is voted among all workers.
+class Searcher {
+   public:
+    explicit Searcher(size_t threads = 1);
+    ~Searcher();
+    Searcher(const Searcher&) = delete;
+    Searcher& operator=(const Searcher&) = delete;
+
+    /// Starts searching a copy of pos and returns immediately, after waiting for any previous
+    /// search to finish. onIteration is called after every completed iteration of the main
+    /// worker and onDone once with the final result, both from the search thread. They must not
+    /// call back into the Searcher, except for stop(). The copy shares the state chain of pos,
+    /// which repetitions are detected along, so the StateInfo objects behind pos must stay alive
+    /// and unchanged until the search has finished.
+    void start(const Position& pos,
+               const Limits& limits,
+               Listener onIteration = {},
+               Listener onDone = {});
+    /// Asks the search to stop as soon as possible, without waiting for it.
+    void stop();
+    /// Blocks until the search has finished.
+    void wait();
+    bool searching();
+
+    /// Sets the number of search threads, at least one. Waits for any running search to finish.
+    void set_threads(size_t threads);
+    size_t threads() const { return workers.size(); }
+
+    /// Evaluates with network from the next search on, or with the hand-written evaluation if it
+    /// is null. The network must stay loaded while searches use it.
+    void set_network(const NNUE::Network* network);
+
+    /// Resizes the transposition table to mbSize megabytes, or clears it, forgetting what
+    /// previous searches have learned. Both wait for any running search to finish.
+    void set_hash_size(size_t mbSize);
+    void clear_hash();
+
+    /// Returns the result of the last completed iteration. If the search was stopped before the
+    /// first one completed, the best move is the first legal move.
+    Info result();
+
+   private:
+    friend class Worker;
+
+    void idle_loop();
+    void run();
+    void report_iteration(const Info& iteration);
+    const Worker& best_worker() const;
+    uint64_t node_count() const;
+
+    std::mutex mutex{};
+    std::condition_variable cv{};
+    bool running = false;
+    bool exit = false;
+    std::atomic<bool> stopRequested{false};
+
+    // Set before a search starts, read by all workers while running
+    Position rootPos{};
+    Limits limits{};
+    Listener onIteration{};
+    Listener onDone{};
+    std::chrono::steady_clock::time_point startTime{};
+    const NNUE::Network* network = nullptr;
+    TT::Table tt{};
+
+    std::vector<std::unique_ptr<Worker>> workers{};
+
+    Info info{};
+
+    std::thread thread;
+};
+
+}  // namespace Search
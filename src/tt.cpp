@@ -0,0 +1,164 @@
+#include "tt.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace TT {
+
+namespace {
+
+// The generation takes the bits of genBound8 above the bound, it is advanced by GenerationDelta
+// per search and wraps around after 64 searches.
+constexpr int BoundBits = 2;
+constexpr int GenerationDelta = 1 << BoundBits;
+constexpr int GenerationCycle = 0xFF + GenerationDelta;
+constexpr int GenerationMask = 0xFF & (0xFF << BoundBits);
+
+// Depths are stored offset by one, so that a zero depth8 marks an empty entry
+constexpr int DepthOffset = -1;
+
+// A shallower result replaces one of the same position only if it is at most this much shallower
+constexpr int SameKeyDepthMargin = 4;
+
+template <typename T>
+T load_relaxed(const T& field) {
+    return std::atomic_ref<T>(const_cast<T&>(field)).load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void store_relaxed(T& field, T value) {
+    std::atomic_ref<T>(field).store(value, std::memory_order_relaxed);
+}
+
+// The index of a cluster comes from the low bits of the key, so the high ones are stored
+constexpr uint16_t key16_of(Key key) {
+    return uint16_t(key >> 48);
+}
+
+// The number of searches since the entry was written, times GenerationDelta
+constexpr int relative_age(uint8_t genBound8, uint8_t generation8) {
+    return (GenerationCycle + generation8 - genBound8) & GenerationMask;
+}
+
+}  // namespace
+
+void Table::resize(size_t mbSize, size_t threads) {
+    size_t clusters = (mbSize << 20) / sizeof(Cluster);
+    clusterCount = std::bit_floor(std::max<size_t>(clusters, 1));
+
+    // Free the old table first, both may not fit in memory at once
+    table.reset();
+    table = std::make_unique_for_overwrite<Cluster[]>(clusterCount);
+    clear(threads);
+}
+
+// Every thread clears a contiguous slice, so the pages of a fresh table are also first touched
+// by the thread clearing them.
+void Table::clear(size_t threads) {
+    threads = std::clamp<size_t>(threads, 1, clusterCount);
+    const size_t slice = (clusterCount + threads - 1) / threads;
+
+    auto clear_slice = [this, slice](size_t i) {
+        const size_t begin = std::min(i * slice, clusterCount);
+        const size_t end = std::min(begin + slice, clusterCount);
+        std::memset(static_cast<void*>(&table[begin]), 0, (end - begin) * sizeof(Cluster));
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(clear_slice, i);
+    }
+    clear_slice(0);
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    generation8 = 0;
+}
+
+void Table::new_search() {
+    generation8 = uint8_t(generation8 + GenerationDelta);
+}
+
+bool Table::probe(Key key, Data& data) const {
+    const uint16_t key16 = key16_of(key);
+
+    for (const Entry& e : cluster(key)->entry) {
+        const uint8_t depth8 = load_relaxed(e.depth8);
+        if (depth8 && load_relaxed(e.key16) == key16) {
+            const uint8_t genBound8 = load_relaxed(e.genBound8);
+
+            data.move = Move(load_relaxed(e.move16));
+            data.value = load_relaxed(e.value16);
+            data.eval = load_relaxed(e.eval16);
+            data.depth = depth8 + DepthOffset;
+            data.bound = Bound(genBound8 & (GenerationDelta - 1));
+            return true;
+        }
+    }
+    return false;
+}
+
+// An entry of the same position or an empty one is reused. Otherwise the shallowest entry is
+// replaced, counting every search since an entry was written as a ply less.
+void Table::store(Key key, Value value, Bound bound, int depth, Move move, Value eval) {
+    const uint16_t key16 = key16_of(key);
+    Entry* replace = nullptr;
+    int replaceWorth = INT_MAX;
+
+    for (Entry& e : cluster(key)->entry) {
+        const uint8_t depth8 = load_relaxed(e.depth8);
+        if (!depth8 || load_relaxed(e.key16) == key16) {
+            replace = &e;
+            break;
+        }
+
+        const int age = relative_age(load_relaxed(e.genBound8), generation8) / GenerationDelta;
+        const int worth = depth8 - age;
+        if (worth < replaceWorth) {
+            replace = &e;
+            replaceWorth = worth;
+        }
+    }
+
+    Entry& e = *replace;
+    const uint8_t oldDepth8 = load_relaxed(e.depth8);
+    const bool sameKey = oldDepth8 && load_relaxed(e.key16) == key16;
+
+    // Keep the move of the same position if there is no new one
+    if (move || !sameKey) {
+        store_relaxed(e.move16, move.raw());
+    }
+
+    // A much shallower bound does not replace a deeper result of the same search
+    if (!sameKey || bound == BOUND_EXACT ||
+        depth - DepthOffset + SameKeyDepthMargin > oldDepth8 ||
+        relative_age(load_relaxed(e.genBound8), generation8)) {
+        store_relaxed(e.key16, key16);
+        store_relaxed(e.value16, int16_t(value));
+        store_relaxed(e.eval16, int16_t(eval));
+        store_relaxed(e.depth8, uint8_t(depth - DepthOffset));
+        store_relaxed(e.genBound8, uint8_t(generation8 | bound));
+    }
+}
+
+int Table::hashfull() const {
+    const size_t samples = std::min<size_t>(1000, clusterCount);
+    size_t count = 0;
+
+    for (size_t i = 0; i < samples; ++i) {
+        for (const Entry& e : table[i].entry) {
+            count += load_relaxed(e.depth8) &&
+                     (load_relaxed(e.genBound8) & GenerationMask) == generation8;
+        }
+    }
+
+    return int(count * 1000 / (samples * ClusterSize));
+}
+
+}  // namespace TT
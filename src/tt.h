@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "types.h"
+
+namespace TT {
+
+enum Bound : uint8_t {
+    BOUND_NONE,
+    BOUND_UPPER,
+    BOUND_LOWER,
+    BOUND_EXACT = BOUND_UPPER | BOUND_LOWER,
+};
+
+// The contents of an entry, as returned by a probe
+struct Data {
+    Move move = Move::none();
+    Value value = VALUE_NONE;
+    Value eval = VALUE_NONE;
+    int depth = 0;
+    Bound bound = BOUND_NONE;
+};
+
+// A transposition table entry in 10 bytes. Only 16 bits of the key are stored, the cluster index
+// provides the others. Threads read and write the fields with relaxed atomic accesses and no
+// locking, so an entry written concurrently may mix fields of two writes: probes may return wrong
+// data, which callers tolerate by checking the move against the position before using it.
+//
+// genBound bit 0-1: bound
+// genBound bit 2-7: generation of the search that wrote the entry
+struct Entry {
+    uint16_t key16;
+    uint16_t move16;
+    int16_t value16;
+    int16_t eval16;
+    uint8_t depth8;
+    uint8_t genBound8;
+};
+
+constexpr int ClusterSize = 3;
+
+// A probe reads a single cluster, half a cache line
+struct alignas(32) Cluster {
+    Entry entry[ClusterSize];
+    uint8_t padding[2];
+};
+
+static_assert(sizeof(Entry) == 10, "Entry size incorrect");
+static_assert(sizeof(Cluster) == 32, "Cluster size incorrect");
+
+// A transposition table shared by all search threads
+class Table {
+   public:
+    explicit Table(size_t mbSize = 16) { resize(mbSize); }
+
+    /// Resizes the table to the largest power of two number of clusters fitting in mbSize
+    /// megabytes. All entries are cleared, using the given number of threads.
+    void resize(size_t mbSize, size_t threads = 1);
+    void clear(size_t threads = 1);
+
+    /// Ages all entries, called once at the start of every search. Entries of older searches
+    /// are replaced first.
+    void new_search();
+
+    /// Returns true and fills data if an entry for the key is found.
+    bool probe(Key key, Data& data) const;
+    /// Stores the entry over the least valuable one of its cluster. Scores must already be
+    /// relative to the node, not to the root.
+    void store(Key key, Value value, Bound bound, int depth, Move move, Value eval);
+
+    /// Fetches the cluster of key into the cache, without waiting for it.
+    void prefetch(Key key) const { __builtin_prefetch(cluster(key)); }
+
+    /// The permille of entries written by the current search, sampled over the first thousand
+    /// clusters.
+    int hashfull() const;
+
+    size_t size_mb() const { return clusterCount * sizeof(Cluster) >> 20; }
+
+   private:
+    Cluster* cluster(Key key) const { return &table[key & (clusterCount - 1)]; }
+
+    std::unique_ptr<Cluster[]> table{};
+    size_t clusterCount = 0;
+    uint8_t generation8 = 0;
+};
+
+}  // namespace TT
@@ -9,6 +9,31 @@
 using Bitboard = uint64_t;
 using Key = uint_fast64_t;
 
+// Scores are in centipawns from the point of view of the side to move. Mate scores count the
+// plies to mate from the root: mate_in(ply) for the winning side, mated_in(ply) for the loser.
+using Value = int;
+
+constexpr int MAX_PLY = 128;
+
+constexpr Value VALUE_ZERO = 0;
+constexpr Value VALUE_DRAW = 0;
+constexpr Value VALUE_MATE = 32000;
+constexpr Value VALUE_INFINITE = 32001;
+constexpr Value VALUE_NONE = 32002;
+// Endings recognized as won score above it, still well below the mate scores
+constexpr Value VALUE_KNOWN_WIN = 10000;
+
+constexpr Value VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+constexpr Value VALUE_MATED_IN_MAX_PLY = -VALUE_MATE_IN_MAX_PLY;
+
+constexpr Value mate_in(int ply) {
+    return VALUE_MATE - ply;
+}
+
+constexpr Value mated_in(int ply) {
+    return -VALUE_MATE + ply;
+}
+
 enum Color : int8_t {
     WHITE,
     BLACK,
@@ -220,6 +245,50 @@ constexpr CastlingRights cr_from_sq(Square s) {
     }
 }
 
+// A Score holds a middlegame and an endgame value in one integer, so that both are updated with a
+// single addition. The endgame value sits in the upper 16 bits, the middlegame value in the lower
+// 16 bits, whose borrow into the upper half is undone when the endgame value is extracted.
+enum Score : int {
+    SCORE_ZERO
+};
+
+constexpr Score make_score(int mg, int eg) {
+    return Score(int(unsigned(eg) << 16) + mg);
+}
+
+constexpr Value eg_value(Score s) {
+    return Value(int16_t(uint16_t(unsigned(int(s) + 0x8000) >> 16)));
+}
+
+constexpr Value mg_value(Score s) {
+    return Value(int16_t(uint16_t(unsigned(int(s)))));
+}
+
+constexpr Score operator+(Score s1, Score s2) {
+    return Score(int(s1) + int(s2));
+}
+constexpr Score operator-(Score s1, Score s2) {
+    return Score(int(s1) - int(s2));
+}
+constexpr Score operator-(Score s) {
+    return Score(-int(s));
+}
+constexpr Score& operator+=(Score& s1, Score s2) {
+    return s1 = s1 + s2;
+}
+constexpr Score& operator-=(Score& s1, Score s2) {
+    return s1 = s1 - s2;
+}
+
+constexpr Value PawnValue = 100;
+constexpr Value KnightValue = 320;
+constexpr Value BishopValue = 330;
+constexpr Value RookValue = 500;
+constexpr Value QueenValue = 900;
+
+constexpr std::array<Value, PIECE_TYPE_NB> PieceValue = {
+    VALUE_ZERO, PawnValue, KnightValue, BishopValue, RookValue, QueenValue, VALUE_ZERO, VALUE_ZERO};
+
 constexpr std::array<char, 12> PieceChars = {'P', 'N', 'B', 'R', 'Q', 'K',
                                              'p', 'n', 'b', 'r', 'q', 'k'};
 
@@ -11,3 +11,11 @@ std::vector<std::string> split_string(std::string s,
     tokens.push_back(s);
     return tokens;
 }
+
+Kernel best_kernel() {
+    static const Kernel kernel =
+        __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq") ? AVX512
+        : __builtin_cpu_supports("avx2")                                                ? AVX2
+                                                                                        : SCALAR;
+    return kernel;
+}
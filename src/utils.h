@@ -1,6 +1,40 @@
 #pragma once
 
+#include <cassert>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 std::vector<std::string> split_string(std::string s, const std::string& delimiter);
+
+// The instruction sets the vectorized kernels are compiled for, from narrowest to widest. AVX512
+// also needs the VPOPCNTDQ extension.
+enum Kernel {
+    SCALAR,
+    AVX2,
+    AVX512,
+};
+
+// Returns the widest kernel supported by the CPU
+Kernel best_kernel();
+
+// xorshift64star Pseudo-Random Number Generator. Usable in constant expressions, so tables of
+// random numbers (e.g. Zobrist keys) can be generated at compile time.
+// Based on original code written and dedicated to the public domain by Sebastiano Vigna (2014).
+class PRNG {
+   public:
+    constexpr explicit PRNG(uint64_t seed) : s(seed) { assert(seed); }
+
+    template <typename T>
+    constexpr T rand() {
+        return T(rand64());
+    }
+
+   private:
+    uint64_t s;
+
+    constexpr uint64_t rand64() {
+        s ^= s >> 12, s ^= s << 25, s ^= s >> 27;
+        return s * 2685821657736338717LL;
+    }
+};
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "../src/batch.h"
+#include "../src/movegen.h"
+#include "../src/pretty.h"
+#include "../src/utils.h"
+#include "positions.h"
+
+namespace {
+
+// Collects positions from random walks, so that the batch contains both sides to move, en passant
+// squares and promotions. Positions in check are left out, as the batch does not take them.
+std::vector<Position> walked_positions() {
+    PRNG rng(20260212);
+    std::vector<Position> positions;
+
+    forEachWalkedPosition(
+        rng,
+        [&](const Position& pos) {
+            if (!pos.checkers()) {
+                positions.emplace_back(pos.as_fen());
+            }
+        },
+        12);
+
+    return positions;
+}
+
+uint32_t expected_move_count(const Position& pos) {
+    uint32_t count = 0;
+    for (const auto& m : MoveList<NON_EVASIONS>(pos)) {
+        count += m.type_of() != CASTLING;
+    }
+    return count;
+}
+
+Bitboard expected_attacks(const Position& pos) {
+    Bitboard attacks = 0;
+    for (Bitboard b = pos.pieces(pos.side_to_move()); b;) {
+        Square s = pop_lsb(b);
+        attacks |= attacks_bb(pos.piece_on(s), s, pos.pieces());
+    }
+    return attacks;
+}
+
+void test_kernel(Kernel kernel) {
+    const std::vector<Position> positions = walked_positions();
+    Batch::PositionBatch batch;
+    Batch::BatchResult result;
+
+    for (const Position& pos : positions) {
+        batch.push_back(pos);
+    }
+    Batch::generate(batch, result, kernel);
+
+    ASSERT_EQ(result.moveCounts.size(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT_EQ(result.moveCounts[i], expected_move_count(positions[i]))
+            << "Kernel " << kernel << " pos: " << positions[i].as_fen();
+        ASSERT_EQ(result.attacks[i], expected_attacks(positions[i]))
+            << "Kernel " << kernel << " pos: " << positions[i].as_fen() << "\nExpected:\n"
+            << pretty(expected_attacks(positions[i])) << "Actual:\n"
+            << pretty(result.attacks[i]);
+    }
+}
+
+}  // namespace
+
+TEST(TestBatch, ScalarKernelMatchesGenerator) {
+    test_kernel(SCALAR);
+}
+
+TEST(TestBatch, Avx2KernelMatchesGenerator) {
+    if (!__builtin_cpu_supports("avx2")) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    test_kernel(AVX2);
+}
+
+TEST(TestBatch, Avx512KernelMatchesGenerator) {
+    if (best_kernel() != AVX512) {
+        GTEST_SKIP() << "AVX-512 is not supported";
+    }
+    test_kernel(AVX512);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <cerrno>
 #include "../src/pretty.h"
+#include "../src/utils.h"
 
 class TestBitboard : public testing::Test {
    protected:
@@ -66,3 +67,48 @@ TEST_F(TestBitboard, LinesBBWorks) {
     test_line(SQ_B6, SQ_E6, Rank6BB);
     test_line(SQ_E4, SQ_A2, 0);
 }
+
+// The tables are built at compile time, so they are usable in constant expressions
+static_assert(between_bb(SQ_A1, SQ_D4) == (SQ_B2 | SQ_C3 | SQ_D4));
+static_assert(line_bb(SQ_A1, SQ_A3) == FileABB);
+static_assert(attacks_bb<ROOK>(SQ_A1, square_bb(SQ_A3)) == ((Rank1BB ^ SQ_A1) | SQ_A2 | SQ_A3));
+
+static_assert(forward_ranks_bb(WHITE, SQ_E6) == (Rank7BB | Rank8BB));
+static_assert(forward_ranks_bb(BLACK, SQ_E2) == Rank1BB);
+static_assert(forward_file_bb(BLACK, SQ_C3) == (SQ_C2 | SQ_C1));
+static_assert(adjacent_files_bb(SQ_A5) == FileBBB);
+static_assert(pawn_attack_span(WHITE, SQ_H6) == (SQ_G7 | SQ_G8));
+static_assert(passed_pawn_span(BLACK, SQ_B3) == (SQ_A2 | SQ_B2 | SQ_C2 | SQ_A1 | SQ_B1 | SQ_C1));
+
+template <PieceType Pt, Bitboards::SliderBackend B>
+void test_slider_backend(Square s, Bitboard occupied) {
+    Bitboard expected = Bitboards::sliding_attack(Pt, s, occupied);
+    Bitboard result = slider_attacks<Pt, B>(s, occupied);
+    ASSERT_EQ(result, expected) << "Backend " << int(B) << ": " << Pt << " on " << s
+                                << " with occupation:\n"
+                                << pretty(occupied) << "Expected:\n"
+                                << pretty(expected) << "Actual:\n"
+                                << pretty(result);
+}
+
+TEST_F(TestBitboard, SliderBackendsMatchSlidingAttack) {
+    PRNG rng(1070372);
+    const bool hasPext = __builtin_cpu_supports("bmi2");
+
+    for (Square s = SQ_A1; s <= SQ_H8; ++s) {
+        for (int i = 0; i < 1000; ++i) {
+            // Sparse occupancies reach the far ends of the rays more often
+            Bitboard occupied = rng.rand<Bitboard>() & rng.rand<Bitboard>();
+
+            test_slider_backend<BISHOP, Bitboards::MAGIC>(s, occupied);
+            test_slider_backend<ROOK, Bitboards::MAGIC>(s, occupied);
+            test_slider_backend<BISHOP, Bitboards::HYPERBOLA>(s, occupied);
+            test_slider_backend<ROOK, Bitboards::HYPERBOLA>(s, occupied);
+
+            if (hasPext) {
+                test_slider_backend<BISHOP, Bitboards::PEXT>(s, occupied);
+                test_slider_backend<ROOK, Bitboards::PEXT>(s, occupied);
+            }
+        }
+    }
+}
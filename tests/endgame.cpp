@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "../src/endgame.h"
+
+TEST(TestEndgames, ProbesKnownKPKPositions) {
+    // The king on the sixth rank in front of its pawn wins with either side to move
+    ASSERT_TRUE(Endgames::probe_kpk(SQ_D6, SQ_D5, SQ_D8, WHITE));
+    ASSERT_TRUE(Endgames::probe_kpk(SQ_D6, SQ_D5, SQ_D8, BLACK));
+    // On the fifth rank it needs the opposition
+    ASSERT_FALSE(Endgames::probe_kpk(SQ_D5, SQ_D4, SQ_D7, WHITE));
+    ASSERT_TRUE(Endgames::probe_kpk(SQ_D5, SQ_D4, SQ_D7, BLACK));
+    // The rook pawn cannot drive the king out of the corner
+    ASSERT_FALSE(Endgames::probe_kpk(SQ_A1, SQ_A2, SQ_A8, WHITE));
+    // The pawn runs faster than the king
+    ASSERT_TRUE(Endgames::probe_kpk(SQ_A1, SQ_C5, SQ_G6, WHITE));
+    ASSERT_FALSE(Endgames::probe_kpk(SQ_A1, SQ_C5, SQ_G6, BLACK));
+}
+
+TEST(TestEndgames, EvaluatesKPKForEitherSide) {
+    const Value win = Endgames::kpk(Position("8/4k3/8/4K3/4P3/8/8/8 b - - 0 1"), WHITE);
+    ASSERT_LT(win, -VALUE_KNOWN_WIN);
+    ASSERT_EQ(Endgames::kpk(Position("8/4k3/8/4K3/4P3/8/8/8 w - - 0 1"), WHITE), VALUE_DRAW);
+
+    // Mirrored: black pawn on the kingside
+    ASSERT_EQ(Endgames::kpk(Position("8/8/8/3p4/3k4/8/3K4/8 w - - 0 1"), BLACK), win);
+    ASSERT_EQ(Endgames::kpk(Position("8/8/8/3p4/3k4/8/3K4/8 b - - 0 1"), BLACK), VALUE_DRAW);
+}
+
+TEST(TestEndgames, DrivesTheKingToTheBishopCorner) {
+    // The bishop on c1 controls the dark corners a1 and h8
+    const Value dark = Endgames::kbnk(Position("7k/8/5K2/8/8/8/8/2B1N3 w - - 0 1"), WHITE);
+    const Value light = Endgames::kbnk(Position("k7/8/2K5/8/8/8/8/2B1N3 w - - 0 1"), WHITE);
+
+    ASSERT_GT(light, VALUE_KNOWN_WIN);
+    ASSERT_GT(dark, light);
+    ASSERT_EQ(Endgames::kbnk(Position("7k/8/5K2/8/8/8/8/2B1N3 b - - 0 1"), WHITE), -dark);
+}
+
+TEST(TestEndgames, EvaluatesRookAgainstPawn) {
+    // The king stops the pawn
+    ASSERT_GT(Endgames::krkp(Position("4k3/8/8/8/4p3/8/8/R3K3 w - - 0 1"), WHITE),
+              RookValue - PawnValue);
+    // The supported pawn is about to promote and the king is far away
+    ASSERT_LT(Endgames::krkp(Position("8/K7/8/8/8/8/4pk2/7R w - - 0 1"), WHITE), PawnValue);
+}
+
+TEST(TestEndgames, ScalesWrongBishopRookPawns) {
+    ASSERT_EQ(Endgames::kbpsk(Position("6k1/8/8/8/8/7P/4B3/6K1 w - - 0 1"), WHITE),
+              Endgames::ScaleFactorDraw);
+    // The bishop controls the promotion square
+    ASSERT_EQ(Endgames::kbpsk(Position("6k1/8/8/8/8/7P/3B4/6K1 w - - 0 1"), WHITE),
+              Endgames::ScaleFactorNone);
+    // The king is too far from the corner
+    ASSERT_EQ(Endgames::kbpsk(Position("8/8/8/4k3/8/7P/4B3/6K1 w - - 0 1"), WHITE),
+              Endgames::ScaleFactorNone);
+}
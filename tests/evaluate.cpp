@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include "../src/evaluate.h"
+#include "../src/movegen.h"
+#include "positions.h"
+
+TEST(TestEvaluate, SymmetricPositionsAreEqual) {
+    ASSERT_EQ(Eval::evaluate(Position()), VALUE_ZERO);
+    ASSERT_EQ(Eval::evaluate(Position("4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 b - - 0 1")), VALUE_ZERO);
+}
+
+TEST(TestEvaluate, MirroredPositionsScoreTheSameForTheSideToMove) {
+    for (const auto& [white, black] : mirroredPositions) {
+        ASSERT_EQ(Eval::evaluate(Position(white)), Eval::evaluate(Position(black))) << white;
+    }
+}
+
+TEST(TestEvaluate, ExtraMaterialIsAnAdvantage) {
+    const Position pos{"rnb1kbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
+
+    ASSERT_GT(Eval::evaluate(pos), QueenValue - PawnValue);
+}
+
+TEST(TestEvaluate, PhaseTapersFromMiddlegameToEndgame) {
+    ASSERT_EQ(Eval::game_phase(Position()), Eval::MaxPhase);
+    ASSERT_EQ(Eval::game_phase(Position("4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1")), 0);
+    ASSERT_EQ(Eval::game_phase(Position("4k3/8/8/8/8/8/8/R2QK3 w - - 0 1")), 6);
+}
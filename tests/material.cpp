@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "../src/evaluate.h"
+#include "../src/material.h"
+
+namespace {
+
+Material::Entry evaluate(const Position& pos) {
+    Material::Entry e;
+    Material::evaluate(pos, e);
+    return e;
+}
+
+}  // namespace
+
+TEST(TestMaterial, RecognizesEndings) {
+    const std::pair<std::string, Endgames::EvalFunction> endings[] = {
+        {"8/4k3/8/4K3/4P3/8/8/8 w - - 0 1", &Endgames::kpk},
+        {"7k/8/5K2/8/8/8/8/2B1N3 w - - 0 1", &Endgames::kbnk},
+        {"4k3/8/8/8/4p3/8/8/R3K3 w - - 0 1", &Endgames::krkp},
+        {"4k3/8/8/8/8/8/8/2B1K3 w - - 0 1", &Endgames::insufficient_material},
+        {"4k3/8/8/8/8/8/8/1N2KN2 w - - 0 1", &Endgames::insufficient_material},
+        {"3bk3/8/8/8/8/8/8/1N2K3 w - - 0 1", &Endgames::insufficient_material},
+    };
+
+    for (const auto& [fen, function] : endings) {
+        const Material::Entry e = evaluate(Position(fen));
+        ASSERT_EQ(e.evaluationFunction, function) << fen;
+        ASSERT_EQ(e.strongSide, WHITE) << fen;
+    }
+
+    const Material::Entry e = evaluate(Position("8/8/8/3p4/3k4/8/3K4/8 w - - 0 1"));
+    ASSERT_EQ(e.evaluationFunction, &Endgames::kpk);
+    ASSERT_EQ(e.strongSide, BLACK);
+
+    ASSERT_FALSE(evaluate(Position()).specialized_eval_exists());
+    ASSERT_FALSE(evaluate(Position("4k3/8/8/8/8/8/8/R3K3 w - - 0 1")).specialized_eval_exists());
+}
+
+TEST(TestMaterial, ScalesDrawishEndings) {
+    const Position wrongBishop{"6k1/8/8/8/8/7P/4B3/6K1 w - - 0 1"};
+    ASSERT_EQ(evaluate(wrongBishop).scale_factor(wrongBishop, WHITE), Endgames::ScaleFactorDraw);
+    ASSERT_LT(Eval::evaluate(wrongBishop), PawnValue);
+    ASSERT_GT(Eval::evaluate(Position("6k1/8/8/8/8/7P/3B4/6K1 w - - 0 1")), BishopValue);
+
+    // A rook against a minor piece is hard to win, a minor piece up cannot win at all
+    const Position rook{"4k3/3b4/8/8/8/8/8/R3K3 w - - 0 1"};
+    ASSERT_EQ(evaluate(rook).scale_factor(rook, WHITE), 4);
+    const Position minor{"4k3/pp6/8/8/8/8/8/2B1K3 w - - 0 1"};
+    ASSERT_EQ(evaluate(minor).scale_factor(minor, WHITE), Endgames::ScaleFactorDraw);
+    ASSERT_EQ(evaluate(minor).scale_factor(minor, BLACK), Endgames::ScaleFactorNormal);
+}
+
+TEST(TestMaterial, PhaseAndImbalance) {
+    const Material::Entry start = evaluate(Position());
+    ASSERT_EQ(start.game_phase(), Eval::MaxPhase);
+    ASSERT_EQ(start.imbalance(), SCORE_ZERO);
+
+    // Only white keeps its bishop pair
+    const Material::Entry pair =
+        evaluate(Position("r2qk1nr/pppppppp/8/8/8/8/PPPPPPPP/R1BQKB1R w - - 0 1"));
+    ASSERT_GT(mg_value(pair.imbalance()), 0);
+    ASSERT_GT(eg_value(pair.imbalance()), 0);
+}
+
+TEST(TestMaterial, TableCachesEntries) {
+    Material::Table table;
+    const Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    // The same material with the pieces elsewhere
+    const Position other{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R4RK1 b kq - 1 1"};
+
+    const Material::Entry* e = table.probe(pos);
+    ASSERT_EQ(e->key, pos.material_key());
+    ASSERT_EQ(e->game_phase(), Eval::game_phase(pos));
+    ASSERT_EQ(table.probe(other), e);
+
+    Pawns::Table pawns;
+    ASSERT_EQ(Eval::evaluate(pos, pawns, table), Eval::evaluate(pos));
+    ASSERT_EQ(Eval::evaluate(other, pawns, table), Eval::evaluate(other));
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <vector>
 #include "../src/pretty.h"
+#include "../src/utils.h"
 #include "positions.h"
 
 TEST(TestMoveGeneration, NumNodesAreCorrect) {
@@ -18,3 +20,54 @@ TEST(TestMoveGeneration, NumNodesAreCorrect) {
                                       << pos;
     }
 }
+
+// Compares pseudo_legal() with membership in the pseudo-legal move list of the position, for
+// the generated moves, copies of them with corrupted flags and random moves.
+template <GenType T>
+void testPseudoLegal(const Position& pos, PRNG& rng) {
+    const MoveList<T> moves(pos);
+    std::vector<Move> candidates(moves.begin(), moves.end());
+
+    for (const auto& m : moves) {
+        for (int flags = 1; flags < 16; ++flags) {
+            candidates.push_back(Move(m.raw() ^ (flags << 12)));
+        }
+    }
+
+    for (int i = 0; i < 2000; ++i) {
+        candidates.push_back(Move(rng.rand<uint16_t>()));
+    }
+
+    for (Move m : candidates) {
+        ASSERT_EQ(pos.pseudo_legal(m), moves.contains(m))
+            << "m: " << m << " (" << m.raw() << ") pos: " << pos.as_fen();
+    }
+}
+
+TEST(TestMoveGeneration, PseudoLegalMatchesGenerator) {
+    PRNG rng(20260117);
+
+    forEachWalkedPosition(rng, [&](const Position& pos) {
+        if (pos.checkers()) {
+            testPseudoLegal<EVASIONS>(pos, rng);
+        } else {
+            testPseudoLegal<NON_EVASIONS>(pos, rng);
+        }
+    });
+}
+
+TEST(TestMoveGeneration, LegalMatchesFilteredGenerator) {
+    PRNG rng(20260118);
+
+    forEachWalkedPosition(rng, [](const Position& pos) {
+        const MoveList<LEGAL> legal(pos);
+        const MoveList<FILTERED_LEGAL> filtered(pos);
+
+        ASSERT_EQ(legal.size(), filtered.size()) << "pos: " << pos.as_fen() << "\nLegal:\n"
+                                                 << legal << "Filtered:\n"
+                                                 << filtered;
+        for (const auto& m : filtered) {
+            ASSERT_TRUE(legal.contains(m)) << "m: " << m << " pos: " << pos.as_fen();
+        }
+    });
+}
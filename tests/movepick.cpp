@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "../src/movepick.h"
+#include "../src/pretty.h"
+#include "../src/utils.h"
+#include "positions.h"
+
+namespace {
+
+// The stage a move is expected in, when not in check
+enum ExpectedStage { HASH_MOVE, GOOD_CAPTURE, KILLER, QUIET, BAD_CAPTURE };
+
+std::vector<Move> pick_all(const Position& pos, Move ttMove, const std::array<Move, 2>& killers) {
+    MovePicker picker(pos, ttMove, killers);
+    std::vector<Move> moves;
+    while (const Move m = picker.next_move()) {
+        moves.push_back(m);
+    }
+    return moves;
+}
+
+std::vector<Move> sorted(std::vector<Move> moves) {
+    std::sort(moves.begin(), moves.end(), [](Move a, Move b) { return a.raw() < b.raw(); });
+    return moves;
+}
+
+// Calls f on the walked positions with legal moves, with a hash move and killers taken from the
+// pseudo-legal moves, from other positions or invalid.
+template <typename F>
+void forEachPickedPosition(F&& f) {
+    PRNG rng(20261017);
+    std::vector<Move> seen;
+
+    forEachWalkedPosition(rng, [&](const Position& pos) {
+        const MoveList<LEGAL> legal(pos);
+        if (legal.size() == 0) {
+            return;
+        }
+        seen.insert(seen.end(), legal.begin(), legal.end());
+
+        auto random_move = [&]() {
+            switch (rng.rand<uint32_t>() % 4) {
+                case 0: return Move::none();
+                case 1: return Move(rng.rand<uint16_t>());
+                case 2: return seen[rng.rand<size_t>() % seen.size()];
+                default: return legal.begin()[rng.rand<size_t>() % legal.size()];
+            }
+        };
+
+        const Move ttMove = random_move();
+        Move first = random_move(), second = random_move();
+        if (first == second) {
+            second = Move::none();
+        }
+        f(pos, ttMove, std::array<Move, 2>{first, second});
+    });
+}
+
+}  // namespace
+
+TEST(TestMovePicker, HandsOutEveryPseudoLegalMoveOnce) {
+    forEachPickedPosition([](const Position& pos, Move ttMove, const std::array<Move, 2>& killers) {
+        std::vector<Move> expected;
+        if (pos.checkers()) {
+            const MoveList<EVASIONS> moves(pos);
+            expected.assign(moves.begin(), moves.end());
+        } else {
+            const MoveList<NON_EVASIONS> moves(pos);
+            expected.assign(moves.begin(), moves.end());
+        }
+
+        ASSERT_EQ(sorted(pick_all(pos, ttMove, killers)), sorted(expected))
+            << "pos: " << pos.as_fen() << " ttMove: " << ttMove;
+    });
+}
+
+TEST(TestMovePicker, StagesComeInOrder) {
+    forEachPickedPosition([](const Position& pos, Move ttMove, const std::array<Move, 2>& killers) {
+        const std::vector<Move> moves = pick_all(pos, ttMove, killers);
+        if (moves.empty()) {
+            return;
+        }
+
+        // The hash move is the first move whenever it is pseudo-legal
+        if (pos.pseudo_legal(ttMove)) {
+            ASSERT_EQ(moves.front(), ttMove) << pos.as_fen();
+        }
+
+        // In check, captures of the checker come before the other evasions
+        if (pos.checkers()) {
+            auto begin = moves.begin() + (moves.front() == ttMove);
+            ASSERT_TRUE(std::is_partitioned(begin, moves.end(),
+                                            [&](Move m) { return pos.tactical(m); }))
+                << pos.as_fen();
+            return;
+        }
+
+        auto stage_of = [&](Move m) {
+            if (m == ttMove) {
+                return HASH_MOVE;
+            }
+            if (pos.tactical(m)) {
+                return pos.see_ge(m) ? GOOD_CAPTURE : BAD_CAPTURE;
+            }
+            return std::ranges::find(killers, m) != killers.end() ? KILLER : QUIET;
+        };
+
+        for (size_t i = 1; i < moves.size(); ++i) {
+            ASSERT_LE(stage_of(moves[i - 1]), stage_of(moves[i]))
+                << "pos: " << pos.as_fen() << " " << moves[i - 1] << " before " << moves[i];
+        }
+    });
+}
+
+TEST(TestMovePicker, CapturesMostValuableVictimFirst) {
+    // The pawn on d4 can capture the queen on e5 or the knight on c5, the rook on a5 can take the
+    // knight too
+    const Position pos{"4k3/8/8/R1n1q3/3P4/8/8/7K w - - 0 1"};
+    const std::vector<Move> moves = pick_all(pos, Move::none(), {});
+
+    ASSERT_GE(moves.size(), 3u);
+    ASSERT_EQ(moves[0], Move(SQ_D4, SQ_E5));
+    ASSERT_EQ(moves[1], Move(SQ_D4, SQ_C5));
+    ASSERT_EQ(moves[2], Move(SQ_A5, SQ_C5));
+}
+
+TEST(TestMovePicker, KillersComeBeforeOtherQuietMoves) {
+    const Position pos{};
+    const std::array<Move, 2> killers = {Move(SQ_G1, SQ_F3), Move(SQ_E7, SQ_E5)};
+    const std::vector<Move> moves = pick_all(pos, Move(SQ_E2, SQ_E4), killers);
+
+    // The second killer is not pseudo-legal for white, it is skipped
+    ASSERT_EQ(moves.size(), 20u);
+    ASSERT_EQ(moves[0], Move(SQ_E2, SQ_E4));
+    ASSERT_EQ(moves[1], Move(SQ_G1, SQ_F3));
+    ASSERT_EQ(std::count(moves.begin(), moves.end(), Move(SQ_G1, SQ_F3)), 1);
+}
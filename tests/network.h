@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include "../src/nnue.h"
+#include "../src/utils.h"
+
+// There is no trained network in the repository. Tests and benchmarks use random weights, small
+// enough that the accumulators never overflow and every layer has some active outputs.
+inline std::string write_random_network(const std::string& name, uint64_t seed) {
+    auto weights = std::make_unique<NNUE::Weights>();
+    PRNG rng(seed);
+
+    auto fill = [&](auto& values, int range) {
+        using T = std::remove_reference_t<decltype(values[0])>;
+        for (T& v : values) {
+            v = T(int(rng.rand<uint64_t>() % (2 * range + 1)) - range);
+        }
+    };
+
+    fill(weights->ftBiases, 64);
+    for (auto& column : weights->ftWeights) {
+        fill(column, 32);
+    }
+    fill(weights->l1Biases, 2048);
+    for (auto& row : weights->l1Weights) {
+        fill(row, 24);
+    }
+    fill(weights->l2Biases, 2048);
+    for (auto& row : weights->l2Weights) {
+        fill(row, 64);
+    }
+    weights->outBias = 0;
+    fill(weights->outWeights, 127);
+
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    NNUE::write_network(path, *weights);
+    return path;
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include "../src/movegen.h"
+#include "../src/nnue.h"
+#include "../src/search.h"
+#include "../src/utils.h"
+#include "network.h"
+#include "positions.h"
+
+namespace {
+
+class TestNNUE : public ::testing::Test {
+   protected:
+    static void SetUpTestSuite() {
+        path = write_random_network("chess-tests.nnue", 20261017);
+        ASSERT_TRUE(network.load(path));
+    }
+
+    static void TearDownTestSuite() {
+        network.unload();
+        std::filesystem::remove(path);
+    }
+
+    static inline NNUE::Network network{};
+    static inline std::string path{};
+};
+
+// Walks random lines from every test position, evaluating each node with the accumulator stack
+// on the way down and again on the way back up, and compares with a full evaluation. Null moves
+// and king moves are mixed in, so refreshes and multi-ply catch-ups are covered.
+void test_incremental(const NNUE::Network& network, Kernel kernel) {
+    PRNG rng(20261017);
+    NNUE::AccumulatorStack stack(kernel);
+
+    for (const auto& fen : all_fens()) {
+        Position pos{fen};
+        StateInfo states[16];
+        const std::vector<Move> line = random_line(pos, rng, std::size(states), true);
+        stack.reset();
+
+        for (size_t i = 0; i < line.size(); ++i) {
+            if (line[i] == Move::null()) {
+                pos.make_null_move(states[i]);
+            } else {
+                pos.make_move(line[i], states[i]);
+            }
+            stack.push(pos.dirty_piece());
+
+            // Skip some evaluations so that updates span several plies
+            if (rng.rand<uint32_t>() % 3) {
+                ASSERT_EQ(stack.evaluate(network, pos), NNUE::evaluate(network, pos))
+                    << "Kernel " << kernel << " pos: " << pos.as_fen();
+            }
+        }
+
+        for (auto m = line.rbegin(); m != line.rend(); ++m) {
+            stack.pop();
+            if (*m == Move::null()) {
+                pos.unmake_null_move();
+            } else {
+                pos.unmake_move(*m);
+            }
+
+            ASSERT_EQ(stack.evaluate(network, pos), NNUE::evaluate(network, pos))
+                << "Kernel " << kernel << " pos: " << pos.as_fen();
+        }
+    }
+}
+
+}  // namespace
+
+TEST_F(TestNNUE, RejectsInvalidFiles) {
+    NNUE::Network net;
+    ASSERT_FALSE(net.load("/nonexistent/chess.nnue"));
+    ASSERT_FALSE(net.loaded());
+
+    // A truncated network
+    const std::string truncated =
+        (std::filesystem::temp_directory_path() / "chess-truncated.nnue").string();
+    {
+        std::ofstream file(truncated, std::ios::binary);
+        const NNUE::Header header{};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    ASSERT_FALSE(net.load(truncated));
+    std::filesystem::remove(truncated);
+
+    // Loading a valid network after a failure works, a failed load drops the previous network
+    ASSERT_TRUE(net.load(path));
+    ASSERT_TRUE(net.loaded());
+    ASSERT_EQ(NNUE::evaluate(net, Position()), NNUE::evaluate(network, Position()));
+    ASSERT_FALSE(net.load("/nonexistent/chess.nnue"));
+    ASSERT_FALSE(net.loaded());
+}
+
+TEST_F(TestNNUE, ScalarIncrementalUpdatesMatchFullEvaluation) {
+    test_incremental(network, SCALAR);
+}
+
+TEST_F(TestNNUE, Avx2IncrementalUpdatesMatchFullEvaluation) {
+    if (!__builtin_cpu_supports("avx2")) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    test_incremental(network, AVX2);
+}
+
+TEST_F(TestNNUE, KernelsAgree) {
+    if (!__builtin_cpu_supports("avx2")) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+
+    for (const auto& fen : all_fens()) {
+        Position pos{fen};
+        ASSERT_EQ(NNUE::evaluate(network, pos, SCALAR),
+                  NNUE::evaluate(network, pos, AVX2))
+            << fen;
+    }
+}
+
+TEST_F(TestNNUE, MirroredPositionsScoreTheSameForTheSideToMove) {
+    for (const auto& [white, black] : mirroredPositions) {
+        ASSERT_EQ(NNUE::evaluate(network, Position(white)),
+                  NNUE::evaluate(network, Position(black)))
+            << white;
+    }
+}
+
+TEST_F(TestNNUE, EvaluationDependsOnThePosition) {
+    std::set<Value> values;
+    for (const auto& fen : all_fens()) {
+        values.insert(NNUE::evaluate(network, Position(fen)));
+    }
+
+    ASSERT_GT(values.size(), all_fens().size() / 2);
+}
+
+TEST_F(TestNNUE, SearchEvaluatesWithNetwork) {
+    Position pos{};
+    Search::Searcher searcher;
+    searcher.set_network(&network);
+    searcher.start(pos, {.depth = 1});
+    searcher.wait();
+
+    // A one ply search scores the best move by the evaluation of the position after it
+    Value expected = -VALUE_INFINITE;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        Position child = pos;
+        child.make_move(m);
+        expected = std::max(expected, -NNUE::evaluate(network, child));
+    }
+
+    ASSERT_EQ(searcher.result().score, expected);
+
+    searcher.start(pos, {.depth = 5});
+    searcher.wait();
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(searcher.result().best_move()));
+}
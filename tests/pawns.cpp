@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "../src/pawns.h"
+#include "../src/pretty.h"
+
+namespace {
+
+Pawns::Entry evaluate(const Position& pos) {
+    Pawns::Entry e;
+    Pawns::evaluate(pos, e);
+    return e;
+}
+
+}  // namespace
+
+TEST(TestPawns, FindsPassedPawnsAndAttacks) {
+    // The pawn on c3 is stopped by the one on d5, which is stopped in turn
+    const Pawns::Entry e = evaluate(Position("4k3/8/8/3p4/8/2P5/PP3P2/4K3 w - - 0 1"));
+
+    ASSERT_EQ(e.passed_pawns(WHITE), SQ_A2 | SQ_B2 | SQ_F2);
+    ASSERT_EQ(e.passed_pawns(BLACK), 0u);
+    ASSERT_EQ(e.pawn_attacks(WHITE), SQ_A3 | SQ_B3 | SQ_C3 | SQ_B4 | SQ_D4 | SQ_E3 | SQ_G3);
+    ASSERT_EQ(e.pawn_attacks(BLACK), SQ_C4 | SQ_E4);
+    ASSERT_EQ(e.pawn_attacks_span(BLACK), (SQ_C4 | SQ_E4 | SQ_C3 | SQ_E3 | SQ_C2 | SQ_E2) |
+                                               (SQ_C1 | SQ_E1));
+}
+
+TEST(TestPawns, PenalizesWeakPawns) {
+    auto score = [](const std::string& fen) {
+        return mg_value(evaluate(Position(fen)).pawn_score(WHITE));
+    };
+
+    const Value connected = score("4k3/8/8/8/8/8/PPP5/4K3 w - - 0 1");
+    ASSERT_LT(score("4k3/8/8/8/8/8/P1P1P3/4K3 w - - 0 1"), connected);  // Isolated
+    ASSERT_LT(score("4k3/8/8/8/8/1P6/1PP5/4K3 w - - 0 1"), connected);  // Doubled
+
+    // The pawn on d2 cannot advance safely and has no neighbour behind to support it
+    ASSERT_LT(score("4k3/8/8/8/2p5/4P3/3P4/4K3 w - - 0 1"),
+              score("4k3/8/8/8/2p5/3P4/4P3/4K3 w - - 0 1"));
+}
+
+TEST(TestPawns, KingShelterFollowsTheKing) {
+    const Position castled{"6k1/5ppp/8/8/8/8/5PPP/6K1 w - - 0 1"};
+    const Position exposed{"6k1/5ppp/8/8/8/8/5PPP/2K5 w - - 0 1"};
+    Pawns::Entry e = evaluate(castled);
+
+    const Score sheltered = e.king_shelter(castled, WHITE);
+    ASSERT_EQ(sheltered, e.king_shelter(castled, BLACK));
+    ASSERT_GT(mg_value(sheltered), mg_value(e.king_shelter(exposed, WHITE)));
+    ASSERT_EQ(e.king_shelter(castled, WHITE), sheltered);
+}
+
+TEST(TestPawns, TableCachesEntries) {
+    Pawns::Table table;
+    const Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    // The same pawns with the pieces elsewhere
+    const Position other{"4k3/p1pp1p2/4p1p1/3P4/1p2P3/7p/PPP2PPP/4K3 b - - 0 1"};
+
+    const Pawns::Entry* e = table.probe(pos);
+    ASSERT_EQ(e->key, pos.pawn_key());
+    ASSERT_EQ(e->passed_pawns(WHITE), evaluate(pos).passed_pawns(WHITE));
+    ASSERT_EQ(table.probes(), 1u);
+    ASSERT_EQ(table.hits(), 0u);
+
+    ASSERT_EQ(table.probe(other), e);
+    ASSERT_EQ(table.probes(), 2u);
+    ASSERT_EQ(table.hits(), 1u);
+
+    table.reset_counters();
+    ASSERT_EQ(table.probes(), 0u);
+
+    table.clear();
+    table.probe(pos);
+    ASSERT_EQ(table.hits(), 0u);
+}
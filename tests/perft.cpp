@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../src/perft.h"
+#include "positions.h"
+
+TEST(TestPerft, HashedNodeCountsAreCorrect) {
+    Perft::HashTable tt(16);
+
+    for (const auto& test : testPositions) {
+        Position pos{test.fen};
+        Perft::Result result = Perft::run(pos, test.depth, &tt);
+
+        ASSERT_EQ(result.nodes, uint64_t(test.nodes)) << "Test instance:\n" << test;
+        ASSERT_EQ(pos.as_fen(), Position(test.fen).as_fen());
+    }
+}
+
+TEST(TestPerft, HashedAndPlainRunsAgree) {
+    Perft::HashTable tt(1);
+    Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10"};
+
+    Perft::Result plain = Perft::run(pos, 3);
+    Perft::Result hashed = Perft::run(pos, 3, &tt);
+    Perft::Result rehashed = Perft::run(pos, 3, &tt);
+
+    ASSERT_EQ(plain.nodes, 97862u);
+    ASSERT_EQ(hashed.nodes, plain.nodes);
+    ASSERT_EQ(rehashed.nodes, plain.nodes);
+    ASSERT_EQ(plain.probes, 0u);
+    ASSERT_EQ(rehashed.hit_rate(), 1.0);
+}
+
+TEST(TestPerft, CopyMakeNodeCountsAreCorrect) {
+    for (const auto& test : testPositions) {
+        if (test.depth > 5)
+            continue;
+
+        const Position pos{test.fen};
+        Perft::Result result = Perft::run_copy_make(pos, test.depth);
+
+        ASSERT_EQ(result.nodes, uint64_t(test.nodes)) << "Test instance:\n" << test;
+    }
+}
+
+TEST(TestPerft, ParallelNodeCountsAreCorrect) {
+    for (const auto& test : testPositions) {
+        if (test.depth > 5)
+            continue;
+
+        Position pos{test.fen};
+        Perft::Result result = Perft::run_parallel(pos, test.depth, 4);
+
+        ASSERT_EQ(result.nodes, uint64_t(test.nodes)) << "Test instance:\n" << test;
+    }
+}
+
+TEST(TestPerft, ParallelHashedRunsAgreeWithSerial) {
+    Perft::HashTable tt(16);
+
+    for (const auto& test : testPositions) {
+        Position pos{test.fen};
+        Perft::Result serial = Perft::run(pos, test.depth);
+        Perft::Result parallel = Perft::run_parallel(pos, test.depth, 3, &tt);
+
+        ASSERT_EQ(parallel.nodes, serial.nodes) << "Test instance:\n" << test;
+    }
+}
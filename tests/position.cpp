@@ -35,3 +35,279 @@ TEST_F(TestPosition, LegalMoveWorks) {
 
     ASSERT_TRUE(position3.legal(Move::make<CASTLING>(SQ_E1, SQ_H1)));
 }
+
+TEST_F(TestPosition, MakeUnmakeRestoresPosition) {
+    for (Position* pos : {&position1, &position2, &position3}) {
+        const std::string fen = pos->as_fen();
+        const Position fresh(fen);
+        StateInfo st;
+
+        for (const auto& m : MoveList<LEGAL>(*pos)) {
+            pos->make_move(m, st);
+            ASSERT_EQ(pos->state()->previous, &st);
+            ASSERT_NE(pos->as_fen(), fen) << "m: " << m;
+            pos->blockers_for_king(WHITE);
+            pos->check_squares(KNIGHT);
+            pos->unmake_move(m);
+            ASSERT_EQ(pos->as_fen(), fen) << "m: " << m;
+
+            // The lazily computed fields are not restored, they are recomputed for this board
+            for (Color c : {WHITE, BLACK}) {
+                ASSERT_EQ(pos->blockers_for_king(c), fresh.blockers_for_king(c)) << "m: " << m;
+            }
+            for (PieceType pt : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN}) {
+                ASSERT_EQ(pos->check_squares(pt), fresh.check_squares(pt)) << "m: " << m;
+            }
+        }
+    }
+}
+
+TEST_F(TestPosition, CopyMakeLeavesParentUntouched) {
+    static_assert(std::is_trivially_copyable_v<Position>);
+
+    for (const Position* pos : {&position1, &position2, &position3}) {
+        const std::string fen = pos->as_fen();
+
+        for (const auto& m : MoveList<LEGAL>(*pos)) {
+            StateInfo st;
+            Position made = *pos;
+            made.make_move(m, st);
+
+            Position child = *pos;
+            child.make_move(m);
+            ASSERT_EQ(child.as_fen(), made.as_fen()) << "m: " << m;
+            ASSERT_EQ(child.key(), made.key()) << "m: " << m;
+            ASSERT_EQ(child.checkers(), made.checkers()) << "m: " << m;
+            ASSERT_EQ(pos->as_fen(), fen) << "m: " << m;
+        }
+    }
+}
+
+void testKeys(Position& pos, int depth) {
+    Position fromFen(pos.as_fen());
+    ASSERT_EQ(pos.key(), fromFen.key()) << pos.as_fen();
+    ASSERT_EQ(pos.pawn_key(), fromFen.pawn_key()) << pos.as_fen();
+    ASSERT_EQ(pos.material_key(), fromFen.material_key()) << pos.as_fen();
+    ASSERT_EQ(pos.psq_score(), fromFen.psq_score()) << pos.as_fen();
+    for (Color c : {WHITE, BLACK}) {
+        ASSERT_EQ(pos.count<ALL_PIECES>(c), popcount(pos.pieces(c))) << pos.as_fen();
+        for (PieceType pt = PAWN; pt <= KING; ++pt) {
+            ASSERT_EQ(pos.count(make_piece(c, pt)), fromFen.count(make_piece(c, pt)))
+                << pos.as_fen();
+        }
+    }
+
+    if (depth == 0)
+        return;
+
+    StateInfo st;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        const Key keyAfter = pos.key_after(m);
+        pos.make_move(m, st);
+
+        if (m.type_of() != CASTLING && pos.ep_square() == SQ_NONE &&
+            pos.state()->castlingRights == st.castlingRights) {
+            ASSERT_EQ(pos.key(), keyAfter) << "m: " << m << " pos: " << pos.as_fen();
+        }
+
+        testKeys(pos, depth - 1);
+        pos.unmake_move(m);
+    }
+}
+
+TEST_F(TestPosition, KeysAndScoresAreIncrementallyUpdated) {
+    testKeys(position1, 2);
+    testKeys(position2, 3);
+    testKeys(position3, 2);
+}
+
+TEST_F(TestPosition, TranspositionsHaveEqualKeys) {
+    Position pos1, pos2;
+    StateInfo states[8];
+
+    const Key startKey = pos1.key();
+    const Move knightTour[] = {{SQ_G1, SQ_F3}, {SQ_G8, SQ_F6}, {SQ_F3, SQ_G1}, {SQ_F6, SQ_G8}};
+    for (int i = 0; i < 4; ++i)
+        pos1.make_move(knightTour[i], states[i]);
+
+    ASSERT_EQ(pos1.key(), startKey);
+
+    const Move order1[] = {{SQ_D2, SQ_D4}, {SQ_D7, SQ_D5}, {SQ_C2, SQ_C4}};
+    const Move order2[] = {{SQ_C2, SQ_C4}, {SQ_D7, SQ_D5}, {SQ_D2, SQ_D4}};
+    for (int i = 0; i < 3; ++i) {
+        pos1.make_move(order1[i], states[4 + i]);
+        pos2.make_move(order2[i], states[i]);
+    }
+
+    ASSERT_EQ(pos1.key(), pos2.key());
+    ASSERT_EQ(pos1.pawn_key(), pos2.pawn_key());
+    ASSERT_NE(pos1.key(), startKey);
+}
+
+void testGivesCheck(Position& pos, int depth) {
+    StateInfo st;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        bool givesCheck = pos.gives_check(m);
+
+        pos.make_move(m, st);
+        Bitboard checkers = pos.checkers();
+        pos.unmake_move(m);
+
+        ASSERT_EQ(givesCheck, bool(checkers)) << "m: " << m << " pos: " << pos.as_fen();
+
+        pos.make_move(m, st, givesCheck);
+        ASSERT_EQ(pos.checkers(), checkers) << "m: " << m << " pos: " << pos.as_fen();
+        if (depth > 1)
+            testGivesCheck(pos, depth - 1);
+        pos.unmake_move(m);
+    }
+}
+
+TEST_F(TestPosition, GivesCheckWorks) {
+    testGivesCheck(position1, 3);
+    testGivesCheck(position2, 3);
+    testGivesCheck(position3, 3);
+
+    // Discovered checks by castling, en passant and promotions
+    for (const std::string fen : {"8/8/8/8/8/8/8/2k1K2R w K - 0 1", "8/8/8/KPp4k/8/8/8/8 w - c6 0 1",
+                                  "7k/8/8/8/3P4/8/1B6/K7 w - - 0 1", "1q2k3/2P5/8/8/8/8/8/4K3 w - - 0 1",
+                                  "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1"}) {
+        Position pos{fen};
+        testGivesCheck(pos, 2);
+    }
+}
+
+void testPackUnpack(Position& pos, int depth) {
+    const PackedPosition packed = pos.pack();
+    const Position unpacked{packed};
+
+    ASSERT_EQ(unpacked.as_fen(), pos.as_fen());
+    ASSERT_EQ(unpacked.key(), pos.key()) << pos.as_fen();
+    ASSERT_EQ(unpacked.pawn_key(), pos.pawn_key()) << pos.as_fen();
+    ASSERT_EQ(unpacked.material_key(), pos.material_key()) << pos.as_fen();
+    ASSERT_EQ(unpacked.checkers(), pos.checkers()) << pos.as_fen();
+    ASSERT_EQ(unpacked.pack(), packed) << pos.as_fen();
+
+    if (depth == 0)
+        return;
+
+    StateInfo st;
+    for (const auto& m : MoveList<LEGAL>(pos)) {
+        pos.make_move(m, st);
+        testPackUnpack(pos, depth - 1);
+        pos.unmake_move(m);
+    }
+}
+
+TEST_F(TestPosition, PackUnpackRoundTrips) {
+    testPackUnpack(position1, 2);
+    testPackUnpack(position2, 3);
+    testPackUnpack(position3, 2);
+
+    // Unpacking replaces the position entirely
+    Position pos = position3;
+    pos.unpack(position2.pack());
+    ASSERT_EQ(pos.as_fen(), position2.as_fen());
+}
+
+TEST_F(TestPosition, StaticExchangeEvaluation) {
+    struct SeeTest {
+        std::string fen;
+        std::string move;
+        Value value;
+    };
+
+    const SeeTest tests[] = {
+        // Undefended and defended pawns
+        {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", PawnValue},
+        {"4k3/8/2p5/3p4/4P3/8/8/4K3 w - - 0 1", "e4d5", VALUE_ZERO},
+        {"4k3/8/8/3p4/8/8/8/4KQ2 w - - 0 1", "f1c4", -QueenValue},
+        // Sliders joining in behind the capturers
+        {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5",
+         PawnValue - KnightValue},
+        {"3r2k1/8/1n6/3p4/8/8/3R4/3QK3 w - - 0 1", "d2d5", PawnValue - RookValue},
+        // Pinned defenders, the pinner being still on the board or the moving piece
+        {"4k3/3n4/8/1B2p3/8/3N4/8/4K3 w - - 0 1", "d3e5", PawnValue},
+        {"4k3/3n4/8/1B2p3/8/3N4/8/4K3 w - - 0 1", "b5d7", KnightValue - BishopValue},
+        {"4k3/3p4/8/1B6/3N4/8/8/4K3 w - - 0 1", "d4c6", PawnValue - KnightValue},
+        {"4k3/3p1p2/4p1Q1/1B6/8/8/8/4K3 w - - 0 1", "g6e6", PawnValue - QueenValue},
+        // The king only captures undefended pieces
+        {"8/8/8/4k3/3p4/8/8/K2R4 w - - 0 1", "d1d4", PawnValue - RookValue},
+        {"8/8/8/4k3/3p4/8/5B2/K2R4 w - - 0 1", "d1d4", PawnValue},
+        // Promotions, including a pawn recapturing on the last rank
+        {"4k3/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7b8q", QueenValue - PawnValue},
+        {"rk6/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8q", RookValue - PawnValue},
+        {"rk6/1P6/8/8/8/8/8/4K3 w - - 0 1", "b7a8n", RookValue - PawnValue},
+        {"3r2k1/2P5/5q2/8/8/8/8/3R2K1 w - - 0 1", "d1d8", RookValue},
+        // En passant, the captured pawn uncovering a rook behind it
+        {"4k3/2p5/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", VALUE_ZERO},
+        {"3rk3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", VALUE_ZERO},
+        {"3rk3/8/8/3pP3/8/8/8/3RK3 w - d6 0 1", "e5d6", PawnValue},
+        // Castling
+        {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1", VALUE_ZERO},
+    };
+
+    for (const auto& [fen, uciMove, value] : tests) {
+        const Position pos{fen};
+        const Move m = uci_to_move(pos, uciMove);
+        ASSERT_TRUE(MoveList<LEGAL>(pos).contains(m)) << fen << " " << uciMove;
+        ASSERT_TRUE(pos.see_ge(m, value)) << fen << " " << uciMove;
+        ASSERT_FALSE(pos.see_ge(m, value + 1)) << fen << " " << uciMove;
+    }
+}
+
+TEST_F(TestPosition, DetectsRepetitions) {
+    Position pos{};
+    StateList states;
+    auto play = [&](std::initializer_list<std::string> moves) {
+        for (const auto& m : moves) {
+            pos.make_move(uci_to_move(pos, m), states.emplace_back());
+        }
+    };
+
+    play({"g1f3", "g8f6", "f3g1", "f6g8"});
+    ASSERT_EQ(pos.state()->repetition, 4);
+
+    // A repetition counts the first time inside the search tree, before its root only the third
+    // occurrence does
+    ASSERT_TRUE(pos.is_draw(5));
+    ASSERT_FALSE(pos.is_draw(4));
+    ASSERT_FALSE(pos.is_draw(0));
+
+    play({"g1f3", "g8f6", "f3g1", "f6g8"});
+    ASSERT_EQ(pos.state()->repetition, -4);
+    ASSERT_TRUE(pos.is_draw(0));
+
+    // A pawn move resets the fifty-move counter, no earlier position can repeat
+    play({"e2e4"});
+    ASSERT_EQ(pos.state()->rule50, 0);
+    ASSERT_EQ(pos.state()->repetition, 0);
+    play({"g8f6", "g1f3", "f6g8"});
+    const Move m = uci_to_move(pos, "f3g1");
+    play({"f3g1"});
+    ASSERT_EQ(pos.state()->rule50, 4);
+    ASSERT_EQ(pos.state()->repetition, 4);
+
+    // Unmaking a move restores the repetition of the previous position
+    pos.unmake_move(m);
+    ASSERT_EQ(pos.state()->repetition, 0);
+}
+
+TEST_F(TestPosition, DetectsFiftyMoveRuleDraws) {
+    Position pos{"8/8/4k3/8/8/3K4/8/7R w - - 99 80"};
+    StateInfo st;
+    ASSERT_FALSE(pos.is_draw(0));
+
+    pos.make_move(uci_to_move(pos, "h1h2"), st);
+    ASSERT_TRUE(pos.is_draw(0));
+
+    // Captures reset the counter
+    Position capture{"8/8/4k3/8/8/3K4/7r/7R w - - 99 80"};
+    capture.make_move(uci_to_move(capture, "h1h2"), st);
+    ASSERT_EQ(capture.state()->rule50, 0);
+    ASSERT_FALSE(capture.is_draw(0));
+
+    // Checkmate takes precedence
+    Position mated{"R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 100 80"};
+    ASSERT_FALSE(mated.is_draw(0));
+}
@@ -1,6 +1,13 @@
+#pragma once
+
 #include <array>
 #include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
+#include "../src/movegen.h"
+#include "../src/utils.h"
+#include "fens.h"
 
 struct TestPosition {
     int depth;
@@ -38,3 +45,68 @@ const std::array<TestPosition, 24> testPositions = {
 inline std::ostream& operator<<(std::ostream& os, const TestPosition& test) {
     return os << "fen: " << test.fen << "\ndepth: " << test.depth << "\nnodes: " << test.nodes;
 }
+
+// Pairs of positions with the colors swapped and the board flipped, the first with white to move
+const std::pair<std::string, std::string> mirroredPositions[] = {
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     "r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 1"},
+    {"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", "8/b2p2k1/8/2P5/8/4K3/8/8 b - - 0 1"},
+};
+
+// The benchmark positions followed by the test positions
+inline std::vector<std::string> all_fens() {
+    std::vector<std::string> fens(BenchmarkPositions);
+    for (const auto& test : testPositions) {
+        fens.push_back(test.fen);
+    }
+    return fens;
+}
+
+// Returns a random line of up to plies legal moves from pos, shorter when it ends in checkmate or
+// stalemate. With nullMoves, one move in 8 out of check is a null move. pos is left unchanged.
+inline std::vector<Move> random_line(Position& pos, PRNG& rng, size_t plies,
+                                     bool nullMoves = false) {
+    std::vector<StateInfo> states(plies);
+    std::vector<Move> line;
+
+    for (StateInfo& st : states) {
+        MoveList<LEGAL> moves(pos);
+        if (moves.size() == 0) {
+            break;
+        }
+
+        if (nullMoves && !pos.checkers() && rng.rand<uint32_t>() % 8 == 0) {
+            pos.make_null_move(st);
+            line.push_back(Move::null());
+        } else {
+            line.push_back(moves[rng.rand<size_t>() % moves.size()]);
+            pos.make_move(line.back(), st);
+        }
+    }
+
+    for (auto m = line.rbegin(); m != line.rend(); ++m) {
+        if (*m == Move::null()) {
+            pos.unmake_null_move();
+        } else {
+            pos.unmake_move(*m);
+        }
+    }
+    return line;
+}
+
+// Calls f on every position of a random line from each benchmark and test position, to reach
+// checks, pins, en passant and promotions as well.
+template <typename F>
+void forEachWalkedPosition(PRNG& rng, F&& f, size_t plies = 16) {
+    for (const auto& fen : all_fens()) {
+        Position pos{fen};
+        std::vector<StateInfo> states(plies);
+        const std::vector<Move> line = random_line(pos, rng, plies);
+
+        f(pos);
+        for (size_t i = 0; i < line.size(); ++i) {
+            pos.make_move(line[i], states[i]);
+            f(pos);
+        }
+    }
+}
@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include "../src/evaluate.h"
+#include "../src/movegen.h"
+#include "../src/pretty.h"
+#include "../src/search.h"
+#include "positions.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+Search::Info search(const Position& pos, const Search::Limits& limits) {
+    Search::Searcher searcher;
+    searcher.start(pos, limits);
+    searcher.wait();
+    return searcher.result();
+}
+
+}  // namespace
+
+TEST(TestSearch, FindsMateInOne) {
+    Position pos{"6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"};
+    Search::Info info = search(pos, {.depth = 3});
+
+    ASSERT_EQ(uci(info.best_move()), "a1a8");
+    ASSERT_EQ(info.score, mate_in(1));
+}
+
+TEST(TestSearch, FindsMateInTwo) {
+    Position pos{"k7/8/2K5/8/8/8/8/7R w - - 0 1"};
+    Search::Info info = search(pos, {.depth = 5});
+
+    ASSERT_EQ(info.score, mate_in(3));
+    ASSERT_EQ(info.pv.size(), 3u);
+}
+
+TEST(TestSearch, CapturesHangingQueen) {
+    Position pos{"4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1"};
+    Search::Info info = search(pos, {.depth = 4});
+
+    ASSERT_EQ(uci(info.best_move()), "d1d5");
+    ASSERT_GT(info.score, RookValue - PawnValue);
+}
+
+TEST(TestSearch, ScoresMatesAndStalemates) {
+    Position mated{"R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1"};
+    Position stalemate{"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"};
+
+    Search::Info info = search(mated, {.depth = 3});
+    ASSERT_EQ(info.best_move(), Move::none());
+    ASSERT_EQ(info.score, mated_in(0));
+
+    info = search(stalemate, {.depth = 3});
+    ASSERT_EQ(info.best_move(), Move::none());
+    ASSERT_EQ(info.score, VALUE_DRAW);
+}
+
+TEST(TestSearch, RespectsDepthAndNodeLimits) {
+    Position pos{};
+
+    Search::Info info = search(pos, {.depth = 4});
+    ASSERT_EQ(info.depth, 4);
+    ASSERT_EQ(info.pv.size(), 4u);
+
+    info = search(pos, {.nodes = 20000});
+    ASSERT_GE(info.nodes, 20000u);
+    ASSERT_LT(info.nodes, 20100u);
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.best_move()));
+}
+
+TEST(TestSearch, ReportsEveryIteration) {
+    Position pos{};
+    Search::Searcher searcher;
+    std::vector<int> depths;
+    Search::Info done;
+
+    searcher.start(
+        pos, {.depth = 5}, [&](const Search::Info& info) { depths.push_back(info.depth); },
+        [&](const Search::Info& info) { done = info; });
+    searcher.wait();
+
+    ASSERT_EQ(depths, std::vector<int>({1, 2, 3, 4, 5}));
+    ASSERT_EQ(done.depth, 5);
+    ASSERT_EQ(done.nodes, searcher.result().nodes);
+    ASSERT_GT(done.nps(), 0.0);
+}
+
+TEST(TestSearch, StartDoesNotBlockAndStopEndsSearch) {
+    Position pos{};
+    Search::Searcher searcher;
+
+    // Without limits the search only ends when stopped, so it is still running on return
+    searcher.start(pos, {});
+    ASSERT_TRUE(searcher.searching());
+
+    std::this_thread::sleep_for(20ms);
+    searcher.stop();
+    searcher.wait();
+
+    ASSERT_FALSE(searcher.searching());
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(searcher.result().best_move()));
+}
+
+TEST(TestSearch, RespectsTimeLimit) {
+    Position pos{};
+
+    auto start = std::chrono::steady_clock::now();
+    Search::Info info = search(pos, {.time = 100ms});
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // The bound is loose, sanitized builds and loaded machines overshoot the limit
+    ASSERT_LT(elapsed, 10 * 100ms);
+    ASSERT_LT(info.depth, MAX_PLY);
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.best_move()));
+}
+
+TEST(TestSearch, PlaysLegalMoves) {
+    Search::Searcher searcher;
+
+    for (const auto& test : testPositions) {
+        Position pos{test.fen};
+        searcher.start(pos, {.depth = 4});
+        searcher.wait();
+
+        Search::Info info = searcher.result();
+        ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.best_move())) << "Test instance:\n" << test;
+
+        // The principal variation is a sequence of legal moves
+        StateInfo states[MAX_PLY];
+        for (size_t i = 0; i < info.pv.size(); ++i) {
+            ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.pv[i])) << "Test instance:\n" << test;
+            pos.make_move(info.pv[i], states[i]);
+        }
+    }
+}
+
+TEST(TestSearch, TranspositionTableIsKeptBetweenSearches) {
+    Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    Search::Searcher searcher;
+
+    searcher.start(pos, {.depth = 6});
+    searcher.wait();
+    Search::Info first = searcher.result();
+    ASSERT_GT(first.hashfull, 0);
+    // The pawn structure rarely changes between nodes
+    ASSERT_GT(first.pawnHits, 500);
+
+    // The second search finds the results of the first one
+    searcher.start(pos, {.depth = 6});
+    searcher.wait();
+    ASSERT_LT(searcher.result().nodes, first.nodes / 2);
+
+    searcher.clear_hash();
+    searcher.start(pos, {.depth = 6});
+    searcher.wait();
+    ASSERT_EQ(searcher.result().nodes, first.nodes);
+}
+
+TEST(TestSearch, MultipleThreadsPlayLegalMoves) {
+    Search::Searcher searcher(4);
+    ASSERT_EQ(searcher.threads(), 4u);
+
+    for (const auto& test : testPositions) {
+        Position pos{test.fen};
+        searcher.start(pos, {.depth = 5});
+        searcher.wait();
+
+        Search::Info info = searcher.result();
+        ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.best_move())) << "Test instance:\n" << test;
+
+        StateInfo states[MAX_PLY];
+        for (size_t i = 0; i < info.pv.size(); ++i) {
+            ASSERT_TRUE(MoveList<LEGAL>(pos).contains(info.pv[i])) << "Test instance:\n" << test;
+            pos.make_move(info.pv[i], states[i]);
+        }
+    }
+}
+
+TEST(TestSearch, MultipleThreadsFindMates) {
+    Search::Searcher searcher(3);
+
+    searcher.start(Position("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1"), {.depth = 3});
+    searcher.wait();
+    ASSERT_EQ(uci(searcher.result().best_move()), "a1a8");
+    ASSERT_EQ(searcher.result().score, mate_in(1));
+
+    searcher.start(Position("k7/8/2K5/8/8/8/8/7R w - - 0 1"), {.depth = 5});
+    searcher.wait();
+    ASSERT_EQ(searcher.result().score, mate_in(3));
+}
+
+TEST(TestSearch, StopEndsAllThreads) {
+    Position pos{};
+    Search::Searcher searcher(4);
+    uint64_t mainNodes = 0;
+
+    searcher.start(pos, {}, [&](const Search::Info& info) { mainNodes = info.nodes; });
+    std::this_thread::sleep_for(50ms);
+    searcher.stop();
+    searcher.wait();
+
+    // The result counts the nodes of all threads
+    ASSERT_FALSE(searcher.searching());
+    ASSERT_GE(searcher.result().nodes, mainNodes);
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(searcher.result().best_move()));
+
+    // Changing the number of threads between searches
+    searcher.set_threads(2);
+    ASSERT_EQ(searcher.threads(), 2u);
+    searcher.start(pos, {.nodes = 20000});
+    searcher.wait();
+    ASSERT_GE(searcher.result().nodes, 20000u);
+    ASSERT_TRUE(MoveList<LEGAL>(pos).contains(searcher.result().best_move()));
+}
+
+TEST(TestQSearch, QuietPositionScoresStaticEval) {
+    Position pos{};
+    uint64_t nodes = 0;
+
+    ASSERT_EQ(Search::qsearch(pos, -VALUE_INFINITE, VALUE_INFINITE, &nodes), Eval::evaluate(pos));
+    ASSERT_EQ(nodes, 1u);
+}
+
+TEST(TestQSearch, ResolvesCaptures) {
+    // The rook wins the hanging queen
+    Position hanging{"4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1"};
+    ASSERT_GT(Search::qsearch(hanging), RookValue - PawnValue);
+
+    // The pawn on d6 is defended, the queen stands pat rather than losing itself for it
+    Position defended{"4k3/2p5/3p4/8/8/8/3Q4/4K3 w - - 0 1"};
+    ASSERT_EQ(Search::qsearch(defended), Eval::evaluate(defended));
+}
+
+TEST(TestQSearch, ScoresCheckmates) {
+    Position mated{"R5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1"};
+    ASSERT_EQ(Search::qsearch(mated), mated_in(0));
+}
+
+TEST(TestQSearch, FailsSoftAndRestoresPosition) {
+    for (const auto& fen : BenchmarkPositions) {
+        Position pos{fen};
+        const std::string before = pos.as_fen();
+        const Key key = pos.key();
+        uint64_t nodes = 0;
+
+        const Value v = Search::qsearch(pos, -VALUE_INFINITE, VALUE_INFINITE, &nodes);
+        ASSERT_GT(nodes, 0u);
+
+        // A window just below the score fails high, one just above fails low
+        ASSERT_GE(Search::qsearch(pos, v - 1, v), v) << fen;
+        ASSERT_LE(Search::qsearch(pos, v, v + 1), v) << fen;
+        ASSERT_EQ(pos.key(), key) << fen;
+        ASSERT_EQ(pos.as_fen(), before);
+    }
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "../src/tt.h"
+#include "../src/utils.h"
+
+namespace {
+
+// Keys differing only in their high bits share a cluster
+Key same_cluster(Key key, int i) {
+    return key ^ (Key(i + 1) << 48);
+}
+
+}  // namespace
+
+TEST(TestTT, StoresAndProbes) {
+    TT::Table tt(1);
+    TT::Data data;
+    const Key key = 0x123456789abcdefULL;
+    const Move m(SQ_E2, SQ_E4);
+
+    ASSERT_FALSE(tt.probe(key, data));
+
+    tt.store(key, -42, TT::BOUND_LOWER, 7, m, 13);
+    ASSERT_TRUE(tt.probe(key, data));
+    ASSERT_EQ(data.move, m);
+    ASSERT_EQ(data.value, -42);
+    ASSERT_EQ(data.eval, 13);
+    ASSERT_EQ(data.depth, 7);
+    ASSERT_EQ(data.bound, TT::BOUND_LOWER);
+
+    ASSERT_FALSE(tt.probe(same_cluster(key, 0), data));
+    ASSERT_FALSE(tt.probe(key + 1, data));
+
+    // A result without a move keeps the move of the same position
+    tt.store(key, 5, TT::BOUND_EXACT, 9, Move::none(), VALUE_NONE);
+    ASSERT_TRUE(tt.probe(key, data));
+    ASSERT_EQ(data.move, m);
+    ASSERT_EQ(data.value, 5);
+    ASSERT_EQ(data.eval, VALUE_NONE);
+    ASSERT_EQ(data.depth, 9);
+
+    // A much shallower bound does not replace it, a slightly shallower one does
+    tt.store(key, 1, TT::BOUND_UPPER, 2, Move::none(), VALUE_NONE);
+    ASSERT_TRUE(tt.probe(key, data));
+    ASSERT_EQ(data.depth, 9);
+    tt.store(key, 1, TT::BOUND_UPPER, 6, Move::none(), VALUE_NONE);
+    ASSERT_TRUE(tt.probe(key, data));
+    ASSERT_EQ(data.depth, 6);
+}
+
+TEST(TestTT, ReplacesShallowAndOldEntriesFirst) {
+    TT::Table tt(1);
+    TT::Data data;
+    const Key key = 0xfedcba987654321ULL & ((Key(1) << 48) - 1);
+
+    for (int i = 0; i < TT::ClusterSize; ++i) {
+        tt.store(same_cluster(key, i), 0, TT::BOUND_EXACT, 10 - i, Move::none(), 0);
+    }
+
+    // The shallowest entry goes
+    tt.store(same_cluster(key, 3), 0, TT::BOUND_EXACT, 1, Move::none(), 0);
+    ASSERT_TRUE(tt.probe(same_cluster(key, 0), data));
+    ASSERT_TRUE(tt.probe(same_cluster(key, 1), data));
+    ASSERT_FALSE(tt.probe(same_cluster(key, 2), data));
+    ASSERT_TRUE(tt.probe(same_cluster(key, 3), data));
+
+    // Every search since an entry was written counts as a ply less: an old entry of depth 9 goes
+    // before a new one of depth 6.
+    for (int i = 0; i < 4; ++i) {
+        tt.new_search();
+    }
+    tt.store(same_cluster(key, 4), 0, TT::BOUND_EXACT, 6, Move::none(), 0);
+    tt.store(same_cluster(key, 5), 0, TT::BOUND_EXACT, 6, Move::none(), 0);
+    ASSERT_TRUE(tt.probe(same_cluster(key, 0), data));
+    ASSERT_FALSE(tt.probe(same_cluster(key, 1), data));
+    ASSERT_FALSE(tt.probe(same_cluster(key, 3), data));
+    ASSERT_TRUE(tt.probe(same_cluster(key, 4), data));
+    ASSERT_TRUE(tt.probe(same_cluster(key, 5), data));
+}
+
+TEST(TestTT, HashfullCountsEntriesOfTheCurrentSearch) {
+    TT::Table tt(1);
+    PRNG rng(20261017);
+
+    ASSERT_EQ(tt.hashfull(), 0);
+
+    // Many more keys than the sampled entries
+    for (int i = 0; i < 1 << 18; ++i) {
+        tt.store(rng.rand<Key>(), 0, TT::BOUND_EXACT, 1, Move::none(), 0);
+    }
+    ASSERT_GT(tt.hashfull(), 950);
+
+    tt.new_search();
+    ASSERT_EQ(tt.hashfull(), 0);
+}
+
+TEST(TestTT, ResizeAndParallelClearEmptyTheTable) {
+    TT::Table tt(1);
+    TT::Data data;
+    PRNG rng(20261017);
+    std::vector<Key> keys(1000);
+
+    for (Key& key : keys) {
+        key = rng.rand<Key>();
+        tt.store(key, 0, TT::BOUND_EXACT, 1, Move::none(), 0);
+    }
+
+    tt.clear(4);
+    for (Key key : keys) {
+        ASSERT_FALSE(tt.probe(key, data));
+    }
+
+    tt.resize(4, 3);
+    ASSERT_EQ(tt.size_mb(), 4u);
+    ASSERT_EQ(tt.hashfull(), 0);
+    for (Key key : keys) {
+        ASSERT_FALSE(tt.probe(key, data));
+    }
+}
+
+TEST(TestTT, ConcurrentStoresAndProbes) {
+    constexpr Key KeyMask = 0xFFFF0000000000FFULL;
+    TT::Table tt(1);
+    std::vector<std::thread> threads;
+
+    // The threads write entries whose fields all derive from the key, to a few clusters, and read
+    // random ones back. Entries may tear, but a probe must never return anything not written.
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&tt, t] {
+            PRNG rng(uint64_t(t) + 1);
+            TT::Data data;
+
+            for (int i = 0; i < 100000; ++i) {
+                const Key key = rng.rand<Key>() & KeyMask;
+                const int depth = int(key % 64) + 1;
+                tt.store(key, depth, TT::BOUND_EXACT, depth, Move(uint16_t(depth)), depth);
+
+                if (tt.probe(rng.rand<Key>() & KeyMask, data)) {
+                    ASSERT_GE(data.depth, 1);
+                    ASSERT_LE(data.depth, 64);
+                    ASSERT_EQ(data.bound, TT::BOUND_EXACT);
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
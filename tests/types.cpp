@@ -47,3 +47,16 @@ TEST(TestTypes, MakePieceWorks) {
 
     EXPECT_EQ(p, W_KNIGHT);
 }
+
+TEST(TestTypes, ScorePacksMiddlegameAndEndgame) {
+    constexpr Score s1 = make_score(-120, 45);
+    constexpr Score s2 = make_score(30, -300);
+
+    static_assert(mg_value(s1) == -120 && eg_value(s1) == 45);
+    EXPECT_EQ(mg_value(s1 + s2), -90);
+    EXPECT_EQ(eg_value(s1 + s2), -255);
+    EXPECT_EQ(mg_value(s1 - s2), -150);
+    EXPECT_EQ(eg_value(s1 - s2), 345);
+    EXPECT_EQ(mg_value(-s1), 120);
+    EXPECT_EQ(eg_value(-s1), -45);
+}
@@ -0,0 +1,162 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../src/bitboard.h"
+#include "../src/movegen.h"
+#include "../src/perft.h"
+#include "../src/position.h"
+#include "../src/pretty.h"
+#include "../src/utils.h"
+
+namespace {
+
+struct Options {
+    int depth = -1;
+    size_t threads = 1;
+    size_t hashMb = 0;
+    bool divide = false;
+    std::string fen = fen_start_position;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--threads N] [--hash MB] [--divide] <depth> [fen [moves m1 m2 ...]]\n"
+              << "  --threads N  count subtrees on N threads (default 1)\n"
+              << "  --hash MB    use a transposition table of MB megabytes (default off)\n"
+              << "  --divide     print the node count of every root move\n";
+}
+
+std::optional<size_t> parse_number(const std::string& s) {
+    size_t value;
+    std::istringstream ss{s};
+    if (!(ss >> value) || !ss.eof()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::optional<Options> parse_options(int argc, char* argv[]) {
+    Options options;
+    std::vector<std::string> fenTokens;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--divide") {
+            options.divide = true;
+        } else if (arg == "--threads" || arg == "--hash") {
+            std::optional<size_t> value = i + 1 < argc ? parse_number(argv[++i]) : std::nullopt;
+            if (!value) {
+                return std::nullopt;
+            }
+            (arg == "--threads" ? options.threads : options.hashMb) = *value;
+        } else if (options.depth < 0) {
+            std::optional<size_t> depth = parse_number(arg);
+            if (!depth) {
+                return std::nullopt;
+            }
+            options.depth = int(*depth);
+        } else {
+            fenTokens.push_back(arg);
+        }
+    }
+
+    if (options.depth < 0 || options.threads == 0) {
+        return std::nullopt;
+    }
+
+    if (!fenTokens.empty()) {
+        options.fen = fenTokens.front();
+        for (size_t i = 1; i < fenTokens.size(); ++i) {
+            options.fen += " " + fenTokens[i];
+        }
+    }
+
+    return options;
+}
+
+// Sets up the position of a FEN string with an optional "moves ..." suffix, as used in
+// benchmarks/positions.h. The states of the setup moves are kept in states.
+std::unique_ptr<Position> setup_position(const std::string& str, StateList& states) {
+    std::vector<std::string> parts = split_string(str, " moves ");
+    auto pos = std::make_unique<Position>(parts.front());
+
+    if (parts.size() > 1) {
+        for (const std::string& token : split_string(parts[1], " ")) {
+            if (token.empty()) {
+                continue;
+            }
+
+            Move m = uci_to_move(*pos, token);
+            if (m == Move::none()) {
+                std::cerr << "Illegal move in setup: " << token << "\n";
+                return nullptr;
+            }
+            pos->make_move(m, states.emplace_back());
+        }
+    }
+
+    return pos;
+}
+
+Perft::Result count(Position& pos, int depth, const Options& options, Perft::HashTable* tt) {
+    return options.threads > 1 ? Perft::run_parallel(pos, depth, options.threads, tt)
+                               : Perft::run(pos, depth, tt);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::optional<Options> options = parse_options(argc, argv);
+    if (!options) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    StateList states;
+    std::unique_ptr<Position> pos = setup_position(options->fen, states);
+    if (!pos) {
+        return EXIT_FAILURE;
+    }
+
+    std::unique_ptr<Perft::HashTable> tt =
+        options->hashMb ? std::make_unique<Perft::HashTable>(options->hashMb) : nullptr;
+
+    Perft::Result total{};
+
+    if (options->divide && options->depth > 0) {
+        StateInfo st;
+        for (const auto& m : MoveList<LEGAL>(*pos)) {
+            pos->make_move(m, st);
+            Perft::Result result = count(*pos, options->depth - 1, *options, tt.get());
+            pos->unmake_move(m);
+
+            std::cout << uci(m) << ": " << result.nodes << "\n";
+            total.nodes += result.nodes;
+            total.probes += result.probes;
+            total.hits += result.hits;
+            total.elapsed += result.elapsed;
+        }
+        std::cout << "\n";
+    } else {
+        total = count(*pos, options->depth, *options, tt.get());
+    }
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(total.elapsed).count();
+
+    std::cout << "Nodes searched: " << total.nodes << "\n"
+              << "Time (ms): " << ms << "\n"
+              << "Nodes/sec: " << uint64_t(total.nps()) << "\n";
+
+    if (tt) {
+        std::cout << "Hash: " << tt->size_mb() << " MB, hit rate " << std::fixed
+                  << std::setprecision(1) << 100 * total.hit_rate() << "%\n";
+    }
+
+    return EXIT_SUCCESS;
+}